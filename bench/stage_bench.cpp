@@ -0,0 +1,302 @@
+/**
+ * @file stage_bench.cpp
+ * @brief Rendimiento de cada etapa del compresor sobre corpus sintéticos.
+ *
+ * Uso:  make bench
+ *       ./bench/stage_bench [--max-size 1G] [--json salida.json]
+ *
+ * Para cada corpus (aleatorio uniforme, Zipf, texto, un solo símbolo) y cada
+ * tamaño (1 KiB, 16 KiB, ... hasta --max-size, 64 MiB por defecto) mide por
+ * separado: histograma, árbol, códigos, codificación (bit-packing),
+ * decodificación y la compresión/descompresión completas en memoria.  Las
+ * etapas por histograma (árbol, códigos) también se expresan en ns/byte del
+ * bloque, para compararlas con las demás.
+ *
+ * Con --json escribe además los resultados en un fichero para comparar
+ * versiones entre sí.  1 GiB necesita unos 3 GiB de RAM (entrada, salida
+ * comprimida y salida decodificada).
+ */
+#include "frequency.h"
+#include "HuffmanTree.h"
+#include "HuffmanCodes.h"
+#include "HuffmanEncoder.h"
+#include "HuffmanDecoder.h"
+#include "BitWriter.h"
+#include "Compressor.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+/* ------------------------------------------------------------------ */
+/*  Corpus sintéticos                                                 */
+/* ------------------------------------------------------------------ */
+
+/** @brief Índices con probabilidad ~ 1/(rango+1) sobre `n` valores. */
+class ZipfSampler {
+public:
+    explicit ZipfSampler(std::size_t n)
+    {
+        double sum = 0;
+        for (std::size_t k = 0; k < n; ++k) {
+            sum += 1.0 / double(k + 1);
+            cdf_.push_back(sum);
+        }
+        for (double& c : cdf_) c /= sum;
+    }
+
+    template <typename Rng>
+    std::size_t operator()(Rng& rng)
+    {
+        double u = std::uniform_real_distribution<double>(0, 1)(rng);
+        return std::min<std::size_t>(
+            std::lower_bound(cdf_.begin(), cdf_.end(), u) - cdf_.begin(), cdf_.size() - 1);
+    }
+
+private:
+    std::vector<double> cdf_;
+};
+
+/** @brief Palabras inventadas con frecuencias Zipf, espacios y saltos de línea. */
+static void fillText(std::vector<uint8_t>& buf, std::mt19937_64& rng)
+{
+    std::vector<std::string> words(4000);
+    for (auto& w : words) {
+        std::size_t len = 1 + rng() % 9;
+        for (std::size_t i = 0; i < len; ++i) w += char('a' + rng() % 26);
+    }
+    ZipfSampler pick(words.size());
+
+    std::size_t i = 0, line = 0;
+    while (i < buf.size()) {
+        const std::string& w = words[pick(rng)];
+        for (char c : w) {
+            if (i == buf.size()) return;
+            buf[i++] = uint8_t(line == 0 ? c - 32 : c);   // mayúscula al empezar
+        }
+        if (i == buf.size()) return;
+        ++line;
+        if (rng() % 12 == 0) { buf[i++] = '.'; if (i < buf.size()) buf[i++] = '\n'; line = 0; }
+        else if (rng() % 10 == 0) buf[i++] = ',';
+        else buf[i++] = ' ';
+    }
+}
+
+struct Corpus {
+    const char*          name;
+    std::vector<uint8_t> data;   ///< tamaño máximo; los menores son prefijos
+};
+
+static std::vector<Corpus> makeCorpora(std::size_t size)
+{
+    std::mt19937_64 rng(12345);
+    std::vector<Corpus> corpora;
+
+    Corpus random{ "random", std::vector<uint8_t>(size) };
+    for (auto& b : random.data) b = uint8_t(rng());
+    corpora.push_back(std::move(random));
+
+    Corpus zipf{ "zipf", std::vector<uint8_t>(size) };
+    ZipfSampler pick(256);
+    for (auto& b : zipf.data) b = uint8_t(pick(rng));
+    corpora.push_back(std::move(zipf));
+
+    Corpus text{ "text", std::vector<uint8_t>(size) };
+    fillText(text.data, rng);
+    corpora.push_back(std::move(text));
+
+    corpora.push_back({ "single", std::vector<uint8_t>(size, 'a') });
+    return corpora;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Medición                                                          */
+/* ------------------------------------------------------------------ */
+
+struct Result {
+    std::string corpus;
+    std::size_t bytes;
+    const char* stage;
+    uint64_t    iterations;
+    double      nsPerByte;
+};
+
+/** @brief Evita que el optimizador descarte un resultado. */
+static volatile uint64_t g_sink;
+
+/**
+ * @brief Tiempo medio de `fn` tras una pasada de calentamiento.
+ *
+ * Repite hasta sumar ~0.2 s (y al menos 3 veces), así los tamaños pequeños
+ * no quedan dominados por la resolución del reloj.
+ */
+template <typename Fn>
+static double secondsPerCall(Fn fn, uint64_t& iterations)
+{
+    using Clock = std::chrono::steady_clock;
+    fn();
+    iterations = 0;
+    auto t0 = Clock::now();
+    double elapsed = 0;
+    do {
+        fn();
+        ++iterations;
+        elapsed = std::chrono::duration<double>(Clock::now() - t0).count();
+    } while (elapsed < 0.2 || iterations < 3);
+    return elapsed / double(iterations);
+}
+
+static bool benchCorpus(const Corpus& corpus, std::size_t size, std::vector<Result>& results)
+{
+    const uint8_t* data = corpus.data.data();
+    auto record = [&](const char* stage, auto fn) {
+        uint64_t iterations;
+        double s = secondsPerCall(fn, iterations);
+        results.push_back({ corpus.name, size, stage, iterations, s * 1e9 / double(size) });
+    };
+
+    /* Estado de cada etapa, preparado con la anterior */
+    Histogram   hist = computeHistogram(data, size);
+    HuffmanTree tree;
+    buildHuffmanTree(hist, tree);
+    CodeTable   table = canonicalCodes(buildCodeLengths(hist, huffman::DEFAULT_MAX_CODE_LEN));
+
+    std::vector<uint8_t> packed((encodedBitCount(hist, table) + 7) / 8 + 8);
+    std::vector<uint8_t> decoded(size);
+    DecodeTable decoder, multi;
+    if (!decoder.build(table) || !multi.build(table, true)) return false;
+
+    record("histogram", [&] { g_sink = computeHistogram(data, size)[0]; });
+    record("tree",      [&] { buildHuffmanTree(hist, tree); g_sink = tree.root; });
+    record("codes",     [&] { g_sink = generateHuffmanCodes(tree)[0].len; });
+    record("encode",    [&] {
+        BitWriter writer(packed.data());
+        encodePacked(data, size, table, writer);
+        g_sink = writer.finish();
+    });
+    record("decode",    [&] {
+        BitReader reader(packed.data(), packed.size());
+        g_sink = decoder.decode(reader, decoded.data(), size);
+    });
+    if (std::memcmp(decoded.data(), data, size) != 0) return false;
+    record("decode-multi", [&] {
+        BitReader reader(packed.data(), packed.size());
+        g_sink = multi.decode(reader, decoded.data(), size);
+    });
+    if (std::memcmp(decoded.data(), data, size) != 0) return false;
+
+    /* Camino completo: bloques, elección de tabla, 4 flujos */
+    huffman::Compressor   compressor;
+    huffman::Decompressor decompressor;
+    std::vector<uint8_t>  image(compressor.compressBound(size));
+    std::size_t imageBytes = 0, restored = 0;
+    record("compress",   [&] {
+        compressor.compress(data, size, image.data(), image.size(), imageBytes);
+    });
+    record("decompress", [&] {
+        g_sink = decompressor.decompress(image.data(), imageBytes,
+                                         decoded.data(), size, restored);
+    });
+    return restored == size && std::memcmp(decoded.data(), data, size) == 0;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Salida                                                            */
+/* ------------------------------------------------------------------ */
+
+static std::string sizeLabel(std::size_t bytes)
+{
+    const char* units[] = { "B", "KiB", "MiB", "GiB" };
+    unsigned u = 0;
+    while (u < 3 && bytes >= 1024 && bytes % 1024 == 0) { bytes /= 1024; ++u; }
+    return std::to_string(bytes) + " " + units[u];
+}
+
+static bool writeJson(const std::string& path, const std::vector<Result>& results)
+{
+    std::ofstream out(path);
+    out << "{\n  \"benchmark\": \"stage_bench\",\n  \"results\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const Result& r = results[i];
+        out << "    { \"corpus\": \"" << r.corpus << "\", \"bytes\": " << r.bytes
+            << ", \"stage\": \"" << r.stage << "\", \"iterations\": " << r.iterations
+            << std::fixed << std::setprecision(4)
+            << ", \"ns_per_byte\": " << r.nsPerByte
+            << ", \"mb_per_s\": " << 1e3 / r.nsPerByte << " }"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "  ]\n}\n";
+    return static_cast<bool>(out);
+}
+
+/** @brief "64M", "1G", "4096"... a bytes. */
+static std::size_t parseSize(const char* text)
+{
+    char* end;
+    std::size_t n = std::strtoull(text, &end, 10);
+    switch (*end) {
+    case 'K': case 'k': return n << 10;
+    case 'M': case 'm': return n << 20;
+    case 'G': case 'g': return n << 30;
+    default:            return n;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t maxSize = std::size_t(64) << 20;
+    std::string jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string opt = argv[i];
+        if (opt == "--max-size" && i + 1 < argc) maxSize = parseSize(argv[++i]);
+        else if (opt == "--json" && i + 1 < argc) jsonPath = argv[++i];
+        else {
+            std::cerr << "usage: stage_bench [--max-size 1G] [--json out.json]\n";
+            return 1;
+        }
+    }
+    if (maxSize < 1024) maxSize = 1024;
+
+    std::vector<std::size_t> sizes;
+    for (std::size_t s = 1024; s <= maxSize; s *= 16) sizes.push_back(s);
+
+    std::cout << std::left << std::setw(8) << "corpus" << std::setw(10) << "size"
+              << std::setw(12) << "stage" << std::right << std::setw(12) << "ns/byte"
+              << std::setw(12) << "MB/s" << '\n';
+
+    bool ok = true;
+    std::vector<Result> results;
+    for (const Corpus& corpus : makeCorpora(sizes.back())) {
+        for (std::size_t size : sizes) {
+            std::size_t first = results.size();
+            if (!benchCorpus(corpus, size, results)) {
+                std::cout << corpus.name << " " << sizeLabel(size) << ": round trip failed!\n";
+                ok = false;
+            }
+            for (std::size_t i = first; i < results.size(); ++i) {
+                const Result& r = results[i];
+                std::cout << std::left << std::setw(8) << r.corpus
+                          << std::setw(10) << sizeLabel(r.bytes)
+                          << std::setw(12) << r.stage << std::right << std::fixed
+                          << std::setprecision(3) << std::setw(12) << r.nsPerByte
+                          << std::setprecision(1) << std::setw(12) << 1e3 / r.nsPerByte << '\n';
+            }
+        }
+    }
+
+    if (!jsonPath.empty()) {
+        if (!writeJson(jsonPath, results)) {
+            std::cerr << "cannot write " << jsonPath << '\n';
+            return 1;
+        }
+        std::cout << "JSON written: " << jsonPath << '\n';
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+/**
+ * @file tree_bench.cpp
+ * @brief Compara el constructor lineal de dos colas con el heap anterior.
+ *
+ * Uso:  make bench     (o ./bench/tree_bench [iteraciones])
+ *
+ * Para cada forma de histograma construye el árbol muchas veces con ambos
+ * métodos, comprueba que las longitudes de código coinciden y muestra el
+ * tiempo medio por árbol.
+ */
+#include "HuffmanTree.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <queue>
+#include <random>
+
+/* ------------------------------------------------------------------ */
+/*  Referencia: min-heap con contador de secuencia (versión anterior) */
+/* ------------------------------------------------------------------ */
+
+struct NodeWrap {
+    uint64_t     frequency;
+    uint16_t     node;
+    std::size_t  seq;
+};
+
+struct Compare {
+    bool operator()(const NodeWrap& a, const NodeWrap& b) const {
+        if (a.frequency != b.frequency)
+            return a.frequency > b.frequency;
+        return a.seq > b.seq;
+    }
+};
+
+static void buildHeapTree(const Histogram& hist, HuffmanTree& tree)
+{
+    tree.clear();
+    std::priority_queue<NodeWrap, std::vector<NodeWrap>, Compare> minHeap;
+    std::size_t seq = 0;
+
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s])
+            minHeap.push({ hist[s], tree.addLeaf(static_cast<char>(s), hist[s]), seq++ });
+
+    while (minHeap.size() > 1) {
+        auto left  = minHeap.top(); minHeap.pop();
+        auto right = minHeap.top(); minHeap.pop();
+        uint16_t parent = tree.addParent(left.node, right.node);
+        minHeap.push({ tree[parent].frequency, parent, seq++ });
+    }
+    if (!minHeap.empty()) tree.root = minHeap.top().node;
+}
+
+/** @brief Longitud de código de cada byte (recorrido desde la raíz). */
+static CodeLengths depthsOf(const HuffmanTree& tree)
+{
+    CodeLengths lengths{};
+    if (tree.empty()) return lengths;
+    std::vector<uint8_t> depth(tree.nodes.size(), 0);
+    for (std::size_t i = tree.root + 1u; i-- > 0;) {
+        const HuffmanNode& n = tree.nodes[i];
+        if (n.isLeaf())
+            lengths[static_cast<unsigned char>(n.character)] = depth[i];
+        else
+            depth[n.left] = depth[n.right] = depth[i] + 1;
+    }
+    return lengths;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Histogramas de prueba                                             */
+/* ------------------------------------------------------------------ */
+
+struct Shape {
+    const char* name;
+    Histogram   hist;
+};
+
+static std::vector<Shape> makeShapes()
+{
+    std::mt19937_64 rng(12345);
+    std::vector<Shape> shapes;
+
+    Histogram text{};                       // ~texto: 64 símbolos, sesgado
+    for (unsigned s = 32; s < 96; ++s) text[s] = 1 + rng() % 5000;
+    shapes.push_back({ "text-64", text });
+
+    Histogram uniform{};                    // 256 símbolos casi iguales
+    for (auto& f : uniform) f = 1000 + rng() % 8;
+    shapes.push_back({ "flat-256", uniform });
+
+    Histogram zipf{};                       // 256 símbolos, ley de Zipf
+    for (unsigned s = 0; s < 256; ++s)
+        zipf[s] = static_cast<uint64_t>(1e7 / (s + 1));
+    shapes.push_back({ "zipf-256", zipf });
+
+    Histogram fib{};                        // árbol degenerado (Fibonacci)
+    uint64_t a = 1, b = 1;
+    for (unsigned s = 0; s < 40; ++s) { fib[s] = a; uint64_t c = a + b; a = b; b = c; }
+    shapes.push_back({ "fib-40", fib });
+
+    return shapes;
+}
+
+template <typename Build>
+static double nsPerTree(const Histogram& hist, int iterations, Build build)
+{
+    HuffmanTree tree;
+    uint64_t sink = 0;
+    auto t0 = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        build(hist, tree);
+        sink += tree.root;
+    }
+    auto t1 = std::chrono::steady_clock::now();
+    if (sink == 42) std::cerr << "";   // evita que el bucle se elimine
+    return std::chrono::duration<double, std::nano>(t1 - t0).count() / iterations;
+}
+
+int main(int argc, char* argv[])
+{
+    int iterations = argc > 1 ? std::atoi(argv[1]) : 20000;
+    if (iterations <= 0) iterations = 20000;
+
+    std::cout << std::left << std::setw(10) << "shape"
+              << std::right << std::setw(12) << "heap ns"
+              << std::setw(12) << "2-queue ns" << std::setw(10) << "speedup" << '\n';
+
+    bool ok = true;
+    for (const Shape& shape : makeShapes()) {
+        HuffmanTree a, b;
+        buildHeapTree(shape.hist, a);
+        buildHuffmanTree(shape.hist, b);
+        if (depthsOf(a) != depthsOf(b)) {
+            std::cout << shape.name << ": code lengths differ!\n";
+            ok = false;
+            continue;
+        }
+
+        double heap   = nsPerTree(shape.hist, iterations, buildHeapTree);
+        double linear = nsPerTree(shape.hist, iterations,
+                                  [](const Histogram& h, HuffmanTree& t) { buildHuffmanTree(h, t); });
+        std::cout << std::left << std::setw(10) << shape.name << std::right
+                  << std::fixed << std::setprecision(0)
+                  << std::setw(12) << heap << std::setw(12) << linear
+                  << std::setprecision(2) << std::setw(9) << heap / linear << "x\n";
+    }
+    return ok ? 0 : 1;
+}
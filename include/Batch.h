@@ -0,0 +1,51 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+#include "CompressedIO.h"   // CompressOptions, Stats
+
+namespace huffman {
+namespace util {
+
+/** @brief One file of a batch and, once processed, its outcome. */
+struct BatchFile {
+    std::string input;
+    std::string output;
+    bool        ok = false;
+    std::string error;   ///< why it failed; empty on success
+    Stats       stats;   ///< counters of this file's compress/decompress call
+};
+
+/** @brief Totals over a whole batch. */
+struct BatchReport {
+    std::size_t files       = 0;
+    std::size_t failed      = 0;
+    uint64_t    inputBytes  = 0;   ///< over the files that succeeded
+    uint64_t    outputBytes = 0;
+    uint64_t    totalNs     = 0;   ///< wall time of the whole batch
+};
+
+/** @brief Called on the calling thread for each file, in list order. */
+using BatchCallback = std::function<void(const BatchFile&)>;
+
+/**
+ * @brief Compress every file of `files` with `workers` threads (0 = all cores).
+ *
+ * Files are the unit of parallelism: each one is compressed on a single
+ * thread (`options.threads` is ignored), so reads, encoding and writes of
+ * different files overlap.  Missing parent directories of the outputs are
+ * created.  A failed file is recorded in its BatchFile and does not stop
+ * the others.
+ */
+BatchReport compressBatch(std::vector<BatchFile>& files, const CompressOptions& options,
+                          unsigned workers, const BatchCallback& done = {});
+
+/** @brief Same for decompression; `dictionary` as for readCompressedFile(). */
+BatchReport decompressBatch(std::vector<BatchFile>& files, unsigned workers,
+                            const Dictionary* dictionary = nullptr,
+                            const BatchCallback& done = {});
+
+}  // namespace util
+}  // namespace huffman
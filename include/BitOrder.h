@@ -0,0 +1,39 @@
+#pragma once
+#include <cstdint>
+#include <cstring>   // std::memcpy
+
+/**
+ * @brief Orden de los bits dentro de cada byte de un flujo.
+ *
+ * - MSB: el primer bit del flujo es el bit 7 del primer byte.  Es el orden
+ *        de todos los formatos .huf (los códigos canónicos se leen tal cual).
+ * - LSB: el primer bit es el bit 0 (estilo deflate); un código se escribe
+ *        empezando por su bit bajo, así que los códigos prefijo deben ir
+ *        invertidos.
+ */
+enum class BitOrder { MSB, LSB };
+
+namespace bitio {
+
+/**
+ * @brief Carga 8 bytes sin requisito de alineación, como entero que el
+ *        acumulador de `Order` usa tal cual (big-endian para MSB).
+ */
+template <BitOrder Order>
+inline uint64_t load64(const uint8_t* p)
+{
+    uint64_t v;
+    std::memcpy(&v, p, 8);
+    if constexpr (Order == BitOrder::MSB) v = __builtin_bswap64(v);
+    return v;
+}
+
+/** @brief Guarda 4 bytes sin alineación; MSB: byte alto primero. */
+template <BitOrder Order>
+inline void store32(uint8_t* p, uint32_t v)
+{
+    if constexpr (Order == BitOrder::MSB) v = __builtin_bswap32(v);
+    std::memcpy(p, &v, 4);
+}
+
+}  // namespace bitio
@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "BitOrder.h"
+
+/**
+ * @brief Lector de bits con buffer de 64 bits, en el orden `Order`.
+ *
+ * Contraparte de BasicBitWriter.  refill() deja al menos 57 bits válidos en
+ * el buffer (salvo al final del flujo), de modo que varios peek()/consume()
+ * seguidos no necesitan comprobar límites.  Más allá del final se leen ceros.
+ */
+template <BitOrder Order>
+class BasicBitReader {
+public:
+    BasicBitReader(const uint8_t* src, std::size_t size) : src_(src), size_(size) {}
+
+    /** @brief Rellena el buffer hasta tener >= 57 bits (o agotar la entrada). */
+    void refill()
+    {
+        if (canRefillFast()) {
+            refillFast();
+            return;
+        }
+        while (count_ <= 56) {
+            uint64_t b = pos_ < size_ ? src_[pos_] : 0;
+            if constexpr (Order == BitOrder::MSB)
+                acc_ |= b << (56 - count_);
+            else
+                acc_ |= b << count_;
+            ++pos_;
+            count_ += 8;
+        }
+    }
+
+    /** @brief true si quedan 8 bytes por cargar: refillFast() es seguro. */
+    bool canRefillFast() const { return pos_ + 8 <= size_; }
+
+    /**
+     * @brief refill() sin comprobar límites; requiere canRefillFast().
+     *
+     * Carga 8 bytes de una vez, sin alineación ni bucle: los bits que ya
+     * estaban se vuelven a escribir con el mismo valor, así que el OR es
+     * inocuo.
+     */
+    void refillFast()
+    {
+        uint64_t v = bitio::load64<Order>(src_ + pos_);
+        if constexpr (Order == BitOrder::MSB)
+            acc_ |= v >> count_;
+        else
+            acc_ |= v << count_;
+        unsigned bytes = (63 - count_) >> 3;
+        pos_   += bytes;
+        count_ += bytes * 8;
+    }
+
+    /**
+     * @brief Devuelve los próximos `n` bits sin consumirlos (1 <= n <= 32).
+     *
+     * MSB: el primer bit del flujo queda en el bit más alto del resultado;
+     * LSB: en el bit 0.
+     */
+    uint32_t peek(unsigned n) const
+    {
+        if constexpr (Order == BitOrder::MSB)
+            return uint32_t(acc_ >> (64 - n));
+        else
+            return uint32_t(acc_ & ((uint64_t(1) << n) - 1));
+    }
+
+    /** @brief Descarta `n` bits ya leídos con peek(). */
+    void consume(unsigned n)
+    {
+        if constexpr (Order == BitOrder::MSB)
+            acc_ <<= n;
+        else
+            acc_ >>= n;
+        count_ -= n;
+    }
+
+    /** @brief Bits consumidos desde el inicio del flujo. */
+    uint64_t bitsConsumed() const { return uint64_t(pos_) * 8 - count_; }
+
+private:
+    const uint8_t* src_;
+    std::size_t    size_;
+    std::size_t    pos_   = 0;   ///< próximo byte a cargar
+    uint64_t       acc_   = 0;   ///< bits pendientes (MSB: alineados a la izquierda)
+    unsigned       count_ = 0;   ///< cuántos bits válidos hay en acc_
+};
+
+/** @brief El lector de los formatos .huf. */
+using BitReader = BasicBitReader<BitOrder::MSB>;
@@ -0,0 +1,90 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include "BitOrder.h"
+
+/**
+ * @brief Escritor de bits con acumulador de 64 bits, en el orden `Order`.
+ *
+ * Los códigos se añaden enteros (patrón + longitud) al acumulador y se vuelcan
+ * a bytes empaquetados de 4 en 4 con un solo store, sin pasar nunca por una
+ * cadena de '0'/'1'.  El buffer destino debe tener al menos
+ * ceil(totalBits / 8) bytes: nunca se escribe más allá.
+ */
+template <BitOrder Order>
+class BasicBitWriter {
+public:
+    explicit BasicBitWriter(uint8_t* dst) : dst_(dst) {}
+
+    /**
+     * @brief Añade los `len` bits bajos de `bits` (len <= 32).
+     *
+     * Los bits por encima de `len` deben ser cero.  Con MSB el primer bit
+     * escrito es el más alto de los `len`; con LSB, el bit 0.
+     */
+    void put(uint32_t bits, unsigned len)
+    {
+        // count_ < 32 siempre a la entrada, así que ningún shift llega a 64
+        if constexpr (Order == BitOrder::MSB)
+            acc_ |= (uint64_t(bits) << (32 - len)) << (32 - count_);
+        else
+            acc_ |= uint64_t(bits) << count_;
+        count_ += len;
+        if (count_ >= 32) {
+            if constexpr (Order == BitOrder::MSB) {
+                bitio::store32<Order>(dst_ + pos_, uint32_t(acc_ >> 32));
+                acc_ <<= 32;
+            } else {
+                bitio::store32<Order>(dst_ + pos_, uint32_t(acc_));
+                acc_ >>= 32;
+            }
+            pos_   += 4;
+            count_ -= 32;
+        }
+    }
+
+    /** @brief Igual que put() pero admite códigos de hasta 64 bits. */
+    void putWide(uint64_t bits, unsigned len)
+    {
+        if (len <= 32) {
+            put(uint32_t(bits), len);
+        } else if constexpr (Order == BitOrder::MSB) {
+            put(uint32_t(bits >> 32), len - 32);
+            put(uint32_t(bits), 32);
+        } else {
+            put(uint32_t(bits), 32);
+            put(uint32_t(bits >> 32), len - 32);
+        }
+    }
+
+    /**
+     * @brief Vuelca los bits pendientes (rellenando con ceros hasta el byte).
+     * @return Número total de bytes escritos en el destino.
+     */
+    std::size_t finish()
+    {
+        while (count_ > 0) {
+            if constexpr (Order == BitOrder::MSB) {
+                dst_[pos_++] = uint8_t(acc_ >> 56);
+                acc_ <<= 8;
+            } else {
+                dst_[pos_++] = uint8_t(acc_);
+                acc_ >>= 8;
+            }
+            count_ = count_ > 8 ? count_ - 8 : 0;
+        }
+        return pos_;
+    }
+
+    /** @brief Bits escritos hasta ahora (incluye los aún en el acumulador). */
+    uint64_t bitCount() const { return uint64_t(pos_) * 8 + count_; }
+
+private:
+    uint8_t*    dst_;
+    std::size_t pos_   = 0;
+    uint64_t    acc_   = 0;   ///< bits pendientes (MSB: alineados a la izquierda)
+    unsigned    count_ = 0;   ///< cuántos bits válidos hay en acc_
+};
+
+/** @brief El escritor de los formatos .huf. */
+using BitWriter = BasicBitWriter<BitOrder::MSB>;
@@ -0,0 +1,218 @@
+#pragma once
+#include <cstddef>
+#include <array>
+#include <cstdint>
+#include <vector>
+#include "HuffmanCodes.h"     // CodeLengths, CodeTable
+#include "HuffmanDecoder.h"   // DecodeTable
+
+namespace huffman {
+
+class Dictionary;
+
+/** @brief Longest code a stored length table can describe (4-bit nibbles). */
+constexpr unsigned MAX_STORED_CODE_LEN = 15;
+
+/** @brief Default code-length limit: every code resolves in one root lookup. */
+constexpr unsigned DEFAULT_MAX_CODE_LEN = DecodeTable::TABLE_BITS;
+
+/** @brief Default raw bytes per block inside a frame (0 = one block per frame). */
+constexpr std::size_t DEFAULT_SUB_BLOCK_SIZE = std::size_t(64) << 10;
+
+/** @brief Blocks shorter than this always use the single-stream layout. */
+constexpr std::size_t MIN_INTERLEAVED_SIZE = 1024;
+
+/**
+ * @brief Block types that may appear inside a HUF2 frame.
+ *
+ * Every block starts with `u8 type` + `u32 rawLen`, so a frame body is just a
+ * sequence of blocks whose raw lengths add up to the frame's raw size.  The
+ * REUSE types decode with the code of the previous Huffman or DICT block of
+ * the same frame; codes never cross frames, so frames stay independent.
+ *
+ * BLOCK_CHECKSUM is the exception: it holds no data, only comes first in a
+ * frame, and its u32 field is the CRC-32C of the frame's raw bytes instead
+ * of a length.  Coming first lets the decoder checksum each block while it
+ * is still in cache.
+ */
+enum BlockType : uint8_t {
+    BLOCK_HUFFMAN  = 1,  ///< code lengths + u32 payload bytes + packed payload
+    BLOCK_HUFFMAN4 = 2,  ///< code lengths + 4 × u32 stream bytes + 4 packed streams
+    BLOCK_RAW      = 3,  ///< rawLen stored bytes
+    BLOCK_REUSE    = 4,  ///< like BLOCK_HUFFMAN without the code lengths
+    BLOCK_REUSE4   = 5,  ///< like BLOCK_HUFFMAN4 without the code lengths
+    BLOCK_RLE      = 6,  ///< one byte, repeated rawLen times
+    BLOCK_DICT     = 7,  ///< u32 dictionary id, then as BLOCK_REUSE
+    BLOCK_DICT4    = 8,  ///< u32 dictionary id, then as BLOCK_REUSE4
+    BLOCK_CHECKSUM = 9,  ///< u32 CRC-32C of the frame's raw bytes; no body
+};
+
+/** @brief One past the highest block type (size of per-type counters). */
+constexpr unsigned BLOCK_TYPES = BLOCK_CHECKSUM + 1;
+
+/** @brief Bytes of a BLOCK_CHECKSUM block. */
+constexpr std::size_t CHECKSUM_BLOCK_SIZE = 5;
+
+/**
+ * @brief Read the checksum a frame body starts with.
+ *
+ * @return false if the frame has no BLOCK_CHECKSUM (crc is left alone).
+ */
+bool frameChecksum(const uint8_t* body, std::size_t size, uint32_t& crc);
+
+/**
+ * @brief Append `u16 count` + 4-bit lengths (high nibble first) to `out`.
+ *
+ * `count` is the highest byte value in use + 1, so text only stores ~64 B.
+ */
+void appendCodeLengths(std::vector<uint8_t>& out, const CodeLengths& lengths);
+
+/**
+ * @brief Parse a table written by appendCodeLengths().
+ *
+ * @return Bytes consumed, or 0 if the table is truncated or malformed.
+ */
+std::size_t parseCodeLengths(const uint8_t* src, std::size_t size,
+                             CodeLengths& lengths);
+
+/**
+ * @brief What encoding a run of blocks produced and what it cost.
+ *
+ * The stage times are only measured when the encoder has timing on.
+ */
+struct BlockStats {
+    uint64_t payloadBits = 0;   ///< bits actually written (length-limited code)
+    uint64_t optimalBits = 0;   ///< bits an unbounded Huffman code would need
+    uint64_t codedBytes  = 0;   ///< input bytes coded with a Huffman code
+    uint64_t codedBits   = 0;   ///< payload bits of those bytes
+    unsigned maxCodeLen  = 0;   ///< longest code any coded byte used
+    std::array<uint64_t, BLOCK_TYPES> blocks{};   ///< blocks written, by type
+
+    uint64_t histogramNs = 0;
+    uint64_t treeNs      = 0;   ///< pricing the options, tree build included
+    uint64_t encodeNs    = 0;   ///< writing the chosen block
+
+    BlockStats& operator+=(const BlockStats& other);
+};
+
+/**
+ * @brief Compresses one frame worth of raw bytes into a sequence of blocks.
+ *
+ * The input is cut into blocks of `subBlockSize` bytes.  For each block the
+ * histogram prices the options exactly (sum of count × length, plus the
+ * table bytes for a new code) and the smallest wins: reuse the previous
+ * block's code, use the dictionary (if one is set), send a new code, or
+ * store the bytes raw.  On a tie the cheaper one to decode is taken (raw,
+ * then reuse, then dictionary).
+ *
+ * The tree build is skipped whenever the histogram alone decides: a block
+ * of one repeated byte becomes BLOCK_RLE (runs that span several blocks
+ * share one), a block whose entropy rules out any saving is stored raw, and
+ * a known code that already costs no more than the entropy floor of a new
+ * one (plus its table) is used without pricing the new one.
+ *
+ * The object only holds settings and scratch space, so reusing one instance
+ * across frames avoids re-allocating it each time.
+ */
+class BlockEncoder {
+public:
+    /**
+     * @param maxCodeLen Code-length limit, clamped to [1, MAX_STORED_CODE_LEN].
+     * @param streams    1 = BLOCK_HUFFMAN, 4 = BLOCK_HUFFMAN4 for blocks of at
+     *                   least MIN_INTERLEAVED_SIZE bytes.
+     */
+    explicit BlockEncoder(unsigned maxCodeLen = DEFAULT_MAX_CODE_LEN,
+                          unsigned streams    = DecodeTable::STREAMS)
+    {
+        setMaxCodeLen(maxCodeLen);
+        setStreams(streams);
+    }
+
+    /** @brief Change the code-length limit for the following blocks. */
+    void setMaxCodeLen(unsigned maxCodeLen);
+
+    /** @brief Payload layout for the following blocks: 1 or 4 streams. */
+    void setStreams(unsigned streams);
+
+    /** @brief Raw bytes per block (0 = the whole input is one block). */
+    void setSubBlockSize(std::size_t bytes) { subBlockSize_ = bytes; }
+
+    /** @brief Trained code offered to every block (nullptr = none); not owned. */
+    void setDictionary(const Dictionary* dictionary) { dict_ = dictionary; }
+
+    /** @brief Measure the stage times in the returned BlockStats. */
+    void setTiming(bool on) { timing_ = on; }
+
+    /** @brief Start every frame with a BLOCK_CHECKSUM of its raw bytes. */
+    void setChecksum(bool on) { checksum_ = on; }
+
+    /**
+     * @brief Append the encoded blocks of [data, data + size) to `out`.
+     *
+     * Starts without a previous table, so the result is a self-contained
+     * frame body.  The checksum is taken block by block, right after each
+     * block is encoded, rather than in a pass of its own.
+     *
+     * @param data Raw bytes (size must fit in 32 bits).
+     * @param size Number of bytes.
+     * @param out  Destination; existing contents are kept.
+     * @return Totals for the frame.  Blocks coded without a tree build
+     *         report their payload as the optimum.
+     */
+    BlockStats encode(const uint8_t* data, std::size_t size, std::vector<uint8_t>& out);
+
+private:
+    void      encodeBlock(const uint8_t* data, std::size_t size, std::vector<uint8_t>& out,
+                          BlockStats& stats);
+    uint64_t  writeRun(uint8_t symbol, std::size_t size, std::vector<uint8_t>& out);
+    void      writePayload(const uint8_t* data, std::size_t size, const CodeTable& table,
+                           uint64_t bits, bool interleaved, std::vector<uint8_t>& out);
+
+    unsigned    maxCodeLen_   = DEFAULT_MAX_CODE_LEN;
+    unsigned    streams_      = DecodeTable::STREAMS;
+    std::size_t subBlockSize_ = DEFAULT_SUB_BLOCK_SIZE;
+    bool        timing_       = false;
+    bool        checksum_     = false;
+
+    const Dictionary* dict_ = nullptr;
+
+    /* Code REUSE blocks refer to: lengths_/table_ or the dictionary's */
+    const CodeLengths* prevLengths_ = nullptr;
+    const CodeTable*   prevTable_   = nullptr;
+    CodeLengths        lengths_{};   ///< last new code of this frame
+    CodeTable          table_{};
+
+    static constexpr std::size_t NO_RUN = SIZE_MAX;
+    std::size_t runAt_ = NO_RUN;     ///< offset in `out` of a trailing BLOCK_RLE
+};
+
+/**
+ * @brief Decodes the blocks that make up a frame body.
+ */
+class BlockDecoder {
+public:
+    /** @brief Table for BLOCK_DICT blocks (nullptr = reject them); not owned. */
+    void setDictionary(const Dictionary* dictionary) { dict_ = dictionary; }
+
+    /**
+     * @brief Decode blocks from [src, src + srcSize) into exactly `rawSize` bytes.
+     *
+     * A frame that starts with BLOCK_CHECKSUM is checked block by block as
+     * it decodes, and must match once all its bytes are out.
+     *
+     * @return false if the body is truncated, malformed, does not add up
+     *         to `rawSize` bytes or fails its checksum.
+     */
+    bool decode(const uint8_t* src, std::size_t srcSize,
+                uint8_t* dst, std::size_t rawSize);
+
+private:
+    bool decodePayload(const uint8_t* src, std::size_t srcSize, std::size_t& in,
+                       const DecodeTable& table, uint8_t* dst, std::size_t rawLen,
+                       bool interleaved);
+
+    DecodeTable       table_;
+    const Dictionary* dict_ = nullptr;
+};
+
+}  // namespace huffman
@@ -0,0 +1,27 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace huffman {
+
+/**
+ * @brief CRC-32C (Castagnoli) of [data, data + size), continuing from `crc`.
+ *
+ * Start with 0; crc32c(crc32c(0, a), b) equals the CRC of a followed by b.
+ * Uses the SSE4.2 `crc32` instruction when the CPU has it (three lanes at
+ * once on long buffers) and a slicing-by-8 table otherwise; both give the
+ * same value.
+ */
+uint32_t crc32c(uint32_t crc, const void* data, std::size_t size);
+
+/**
+ * @brief CRC-32C of a followed by b, from crcA = CRC(a), crcB = CRC(b) and
+ *        sizeB = |b|.  Costs O(log sizeB), so frames checksummed apart can
+ *        be chained into a whole-file CRC without touching the bytes again.
+ */
+uint32_t crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB);
+
+/** @brief true if crc32c() runs on the SSE4.2 instruction. */
+bool crc32cHardware();
+
+}  // namespace huffman
@@ -1,28 +1,190 @@
 #pragma once
+#include <array>
+#include <cstddef>
+#include <iosfwd>
 #include <string>
+#include <vector>
+#include "BlockCodec.h"   // DEFAULT_MAX_CODE_LEN
 
 namespace huffman {
 namespace util {
 
+/**
+ * @brief On-disk container versions.
+ *
+ * - HUF0: symbol + uint32 frequency table; the reader rebuilds the tree.
+ * - HUF1: canonical codes; the header only stores 4-bit code lengths.
+ * - HUF2: block-framed stream of canonical-code blocks; both directions
+ *         run in memory bounded by the block size.  A seekable HUF2 file
+ *         also ends with a frame index for random access, and a checked
+ *         one carries a CRC-32C per frame and for the whole file.
+ */
+enum class Format { HUF0, HUF1, HUF2 };
+
+/** @brief First four bytes of each container version. */
+constexpr char MAGIC_HUF0[4] = { 'H','U','F','0' };
+constexpr char MAGIC_HUF1[4] = { 'H','U','F','1' };
+constexpr char MAGIC_HUF2[4] = { 'H','U','F','2' };
+
+/** @brief Last four bytes of a seekable HUF2 file (end of the frame index). */
+constexpr char MAGIC_INDEX[4] = { 'H','U','F','X' };
+
+/** @brief Fixed tail of the index: u64 raw size, u32 frame count, magic. */
+constexpr std::size_t INDEX_FOOTER_SIZE = 16;
+
+/** @brief Starts the whole-file checksum right after the end marker. */
+constexpr char MAGIC_CHECKSUM[4] = { 'H','U','F','C' };
+
+/** @brief Magic + u32 CRC-32C of all raw bytes. */
+constexpr std::size_t CHECKSUM_TRAILER_SIZE = 8;
+
+/** @brief Default raw bytes per HUF2 frame. */
+constexpr std::size_t DEFAULT_BLOCK_SIZE = std::size_t(1) << 20;
+
+/** @brief Largest block size accepted by the writer and the reader. */
+constexpr std::size_t MAX_BLOCK_SIZE = std::size_t(1) << 26;
+
+/**
+ * @brief Counters and stage timings of one compress or decompress call.
+ *
+ * Filled in when a Stats object is passed; the call resets it first.  Stage
+ * times run on the workers when there is a pool, so they are summed over
+ * threads and can exceed `totalNs`.  A mapped input is read lazily: its
+ * page faults land in the first stage that touches the bytes, not READ.
+ *
+ * `optimalBits` is what an unbounded Huffman code would have needed for the
+ * same blocks, so payloadBits / optimalBits is the price of the length limit.
+ */
+struct Stats {
+    enum Stage { READ, HISTOGRAM, TREE, ENCODE, DECODE, WRITE, STAGE_COUNT };
+
+    std::array<uint64_t, STAGE_COUNT> stageNs{};   ///< wall time per stage
+    uint64_t totalNs = 0;                          ///< wall time of the call
+
+    uint64_t inputBytes   = 0;
+    uint64_t outputBytes  = 0;
+    uint64_t codedSymbols = 0;   ///< bytes coded with a Huffman code (compress)
+    uint64_t codedBits    = 0;   ///< payload bits of those symbols
+    uint64_t payloadBits  = 0;   ///< all block payloads, raw and run blocks included
+    uint64_t optimalBits  = 0;
+    unsigned maxCodeLen   = 0;   ///< longest code a symbol was written with
+    uint64_t frames       = 0;   ///< HUF2 frames
+    std::array<uint64_t, BLOCK_TYPES> blocks{};   ///< HUF2 blocks written, by type
+
+    uint64_t peakFrameBytes     = 0;   ///< largest frame buffer held at once
+    uint64_t peakFramesInFlight = 0;   ///< most frames queued on the pool at once
+
+    /** @brief Add the counters and stage times of encoded blocks. */
+    Stats& operator+=(const BlockStats& encoded);
+
+    /** @brief Mean code length of the coded symbols, in bits. */
+    double avgCodeLen() const
+    {
+        return codedSymbols ? double(codedBits) / double(codedSymbols) : 0.0;
+    }
+};
+
+/** @brief Knobs for the compressor; the defaults write streaming HUF2. */
+struct CompressOptions {
+    Format            format       = Format::HUF2;
+    std::size_t       blockSize    = DEFAULT_BLOCK_SIZE;     ///< HUF2 frame size
+    unsigned          threads      = 1;   ///< HUF2 frames / HUF0-1 histogram; 0 = all cores
+    unsigned          maxCodeLen   = DEFAULT_MAX_CODE_LEN;   ///< HUF1/HUF2, at most 15
+    unsigned          streams      = DecodeTable::STREAMS;   ///< HUF2: 1 or 4 streams per block
+    std::size_t       subBlockSize = DEFAULT_SUB_BLOCK_SIZE; ///< HUF2 block size inside a frame; 0 = whole frame
+    const Dictionary* dictionary   = nullptr;                ///< HUF2: trained table blocks may use
+    bool              seekable     = false;                  ///< HUF2: append a frame index (extractRange)
+    bool              checksum     = false;                  ///< HUF2: CRC-32C per frame and for the file
+    Stats*            stats        = nullptr;                ///< optional counters
+};
+
 /**
  * @brief Compress a file into our custom Huffman-binary format.
  *
  * @param inputPath      Path to the original file to compress.
  * @param compressedPath Path where to write the compressed file (.huf).
+ * @param options        Container version, block size and thread count.
  * @return true on success, false on any I/O error.
  */
 bool writeCompressedFile(const std::string& inputPath,
-                         const std::string& compressedPath);
+                         const std::string& compressedPath,
+                         const CompressOptions& options = {});
 
 /**
  * @brief Decompress a file from our custom Huffman-binary format.
  *
+ * HUF0, HUF1 and HUF2 files are accepted; the magic selects the reader.
+ *
  * @param compressedPath Path to the compressed .huf file.
  * @param outputPath     Path where to write the decompressed bytes.
+ * @param threads        Workers for HUF2 frames (0 = all cores).
+ * @param dictionary     Table the file was compressed with, if any.
+ * @param stats          Optional counters and stage timings.
  * @return true on success, false on format or I/O error.
  */
 bool readCompressedFile(const std::string& compressedPath,
-                        const std::string& outputPath);
+                        const std::string& outputPath,
+                        unsigned threads = 1,
+                        const Dictionary* dictionary = nullptr,
+                        Stats* stats = nullptr);
+
+/**
+ * @brief Compress everything readable from `in` into `out`.
+ *
+ * With HUF2 the input is consumed one block at a time, so pipes and files
+ * larger than RAM work.  With `threads` > 1 blocks are encoded in parallel
+ * and the output is byte-identical to the single-threaded one.  HUF0/HUF1
+ * need the whole input in memory.
+ *
+ * @return true on success, false on I/O error or invalid options.
+ */
+bool compressStream(std::istream& in, std::ostream& out,
+                    const CompressOptions& options = {});
+
+/**
+ * @brief Decompress a HUF0/HUF1/HUF2 stream from `in` into `out`.
+ *
+ * HUF2 frames are decoded and written in order; with `threads` > 1 (0 =
+ * all cores) they are decoded in parallel.  Blocks coded with a trained
+ * table need the same `dictionary`; `stats`, if given, receives counters.
+ *
+ * @return true on success, false on format or I/O error.
+ */
+bool decompressStream(std::istream& in, std::ostream& out,
+                      unsigned threads = 1,
+                      const Dictionary* dictionary = nullptr,
+                      Stats* stats = nullptr);
+
+/**
+ * @brief Sum of the raw frame sizes of a complete in-memory HUF2 image.
+ *
+ * Only hops over frame headers, so it is cheap enough to size an output
+ * file or buffer before decoding.
+ *
+ * @return The decompressed size; 0 for an empty image and for anything that
+ *         is not a complete HUF2 image.
+ */
+uint64_t scanHUF2(const uint8_t* data, std::size_t size);
+
+/**
+ * @brief Decode only the bytes [offset, offset + length) of a seekable HUF2 file.
+ *
+ * Every frame but the last holds exactly blockSize raw bytes, so the index
+ * (written with CompressOptions::seekable) maps a raw offset to its frame
+ * by division.  Only the footer, the index entries of the range and the
+ * frames covering it are read and decoded.  A range running past the end
+ * of the data is clipped.
+ *
+ * @param out Receives the bytes (cleared first).
+ * @return false if the file has no index, `offset` is past the end, or on
+ *         format or I/O error.
+ */
+bool extractRange(const std::string& compressedPath, uint64_t offset, uint64_t length,
+                  std::vector<uint8_t>& out, const Dictionary* dictionary = nullptr);
+
+/** @brief Same, from a complete in-memory image. */
+bool extractRange(const uint8_t* data, std::size_t size, uint64_t offset, uint64_t length,
+                  std::vector<uint8_t>& out, const Dictionary* dictionary = nullptr);
 
 }  // namespace util
 }  // namespace huffman
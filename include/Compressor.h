@@ -0,0 +1,95 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "BlockCodec.h"     // BlockEncoder, BlockDecoder
+#include "CompressedIO.h"   // CompressOptions, scanHUF2()
+
+namespace huffman {
+
+/**
+ * @brief Largest HUF2 image compress() can produce for `size` input bytes.
+ *
+ * A block never costs more than its raw bytes, a 5-byte header and the
+ * padding of its interleaved streams; every frame adds 8 bytes and the
+ * container 16 (magic, block size, end marker).  A seekable image adds
+ * 8 bytes per frame and a 16-byte footer for the index; checksums add
+ * 5 bytes per frame and an 8-byte trailer.
+ *
+ * @return The bound, or 0 if `options.blockSize` is out of range.
+ */
+std::size_t compressBound(std::size_t size, const util::CompressOptions& options = {});
+
+/**
+ * @brief Reusable in-memory HUF2 compressor for many small payloads.
+ *
+ * The output is the same HUF2 image writeCompressedFile() produces, written
+ * into the caller's buffer.  The object keeps the block encoder and a frame
+ * buffer between calls, so once it has seen its largest payload a call does
+ * no heap allocation.  One instance per thread; `format` and `threads` in
+ * the options are ignored (always HUF2, on the calling thread).
+ */
+class Compressor {
+public:
+    explicit Compressor(const util::CompressOptions& options = {});
+
+    /** @brief compressBound() for this compressor's options. */
+    std::size_t compressBound(std::size_t size) const
+    {
+        return huffman::compressBound(size, options_);
+    }
+
+    /**
+     * @brief Compress [src, src + srcSize) into [dst, dst + dstCapacity).
+     *
+     * A `dstCapacity` of compressBound(srcSize) always suffices.
+     *
+     * @param written Bytes stored in `dst` on success.
+     * @return false if `dst` is too small or the options are invalid.
+     */
+    bool compress(const uint8_t* src, std::size_t srcSize,
+                  uint8_t* dst, std::size_t dstCapacity, std::size_t& written);
+
+private:
+    util::CompressOptions options_;
+    BlockEncoder          encoder_;
+    std::vector<uint8_t>  frame_;     ///< encoded frame body, reused
+};
+
+/**
+ * @brief Reusable in-memory HUF2 decompressor.
+ *
+ * Frames are decoded straight into the caller's buffer.  The decode table
+ * keeps its memory between calls, so steady-state calls do not allocate.
+ * Only HUF2 images are accepted; HUF0/HUF1 go through decompressStream().
+ */
+class Decompressor {
+public:
+    /** @param dictionary Table for BLOCK_DICT blocks (nullptr = none); not owned. */
+    explicit Decompressor(const Dictionary* dictionary = nullptr)
+    {
+        decoder_.setDictionary(dictionary);
+    }
+
+    /** @brief Decompressed size of a complete HUF2 image (see util::scanHUF2). */
+    static uint64_t contentSize(const uint8_t* src, std::size_t srcSize)
+    {
+        return util::scanHUF2(src, srcSize);
+    }
+
+    /**
+     * @brief Decompress exactly one HUF2 image into [dst, dst + dstCapacity).
+     *
+     * @param written Bytes stored in `dst` on success.
+     * @return false if the image is malformed, fails a checksum, has
+     *         trailing bytes other than its checksum and frame index, or
+     *         does not fit in `dstCapacity`.
+     */
+    bool decompress(const uint8_t* src, std::size_t srcSize,
+                    uint8_t* dst, std::size_t dstCapacity, std::size_t& written);
+
+private:
+    BlockDecoder decoder_;
+};
+
+}  // namespace huffman
@@ -0,0 +1,61 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include "BlockCodec.h"   // DEFAULT_MAX_CODE_LEN, CodeLengths, DecodeTable
+#include "frequency.h"    // Histogram
+
+namespace huffman {
+
+/** @brief First four bytes of a trained table file (.huft). */
+constexpr char MAGIC_HUFT[4] = { 'H','U','F','T' };
+
+/**
+ * @brief Static code trained on a sample corpus and shared by many payloads.
+ *
+ * A HUF2 block coded with it (BLOCK_DICT) stores only the dictionary id, so
+ * small messages pay neither the table bytes nor a tree build.  Every byte
+ * value gets a code, so any input can use it.  The id is a hash of the code
+ * lengths: a reader holding a different table rejects the block.
+ *
+ * File layout: "HUFT" + `u32 id` + the lengths as written by
+ * appendCodeLengths().  The decode table is built once, on train() or
+ * load(), and is only read afterwards, so one Dictionary can serve any
+ * number of threads.
+ */
+class Dictionary {
+public:
+    /**
+     * @brief Build the code from the byte counts of the samples.
+     *
+     * Bytes that never occur in the samples count once, so they still get a
+     * (long) code.
+     *
+     * @param samples    Byte counts of the training corpus.
+     * @param maxCodeLen Code-length limit, clamped to [8, MAX_STORED_CODE_LEN].
+     */
+    void train(const Histogram& samples, unsigned maxCodeLen = DEFAULT_MAX_CODE_LEN);
+
+    /** @brief Write the table to `path`; false on I/O error or if empty. */
+    bool save(const std::string& path) const;
+
+    /** @brief Read a table written by save(); false if missing or malformed. */
+    bool load(const std::string& path);
+
+    bool               empty()       const { return !ready_; }
+    uint32_t           id()          const { return id_; }
+    const CodeLengths& lengths()     const { return lengths_; }
+    const CodeTable&   codes()       const { return codes_; }
+    const DecodeTable& decodeTable() const { return table_; }
+
+private:
+    bool setLengths(const CodeLengths& lengths);
+
+    bool        ready_ = false;
+    uint32_t    id_    = 0;
+    CodeLengths lengths_{};
+    CodeTable   codes_{};
+    DecodeTable table_;
+};
+
+}  // namespace huffman
@@ -0,0 +1,202 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace huffman {
+namespace util {
+
+/** @brief Inputs smaller than this are read through iostreams, not mapped. */
+constexpr std::size_t MMAP_THRESHOLD = std::size_t(1) << 16;
+
+/** @brief Size of the FileWriter staging buffer (and the direct-write cutoff). */
+constexpr std::size_t WRITE_BUFFER_SIZE = std::size_t(1) << 20;
+
+/** @brief Inputs at least this large go through the read/compute/write pipeline. */
+constexpr std::size_t PIPELINE_THRESHOLD = std::size_t(1) << 22;
+
+/** @brief Buffers each pipeline stage may have queued (the back-pressure bound). */
+constexpr unsigned PIPELINE_DEPTH = 4;
+
+/**
+ * @brief Destination for compressed or decompressed bytes.
+ *
+ * The codecs only ever append, so an ostream and a raw file descriptor can
+ * sit behind the same interface.
+ */
+class ByteSink {
+public:
+    virtual ~ByteSink() = default;
+
+    /** @brief Append `size` bytes; false on I/O error. */
+    virtual bool write(const void* data, std::size_t size) = 0;
+
+    /** @brief Push buffered bytes downstream; false on I/O error. */
+    virtual bool flush() { return true; }
+
+    /** @brief Hint that about `bytes` will be written in total. */
+    virtual void preallocate(uint64_t /*bytes*/) {}
+};
+
+/**
+ * @brief Read-only mapping of a whole regular file.
+ *
+ * open() maps the file and advises the kernel that it will be read
+ * sequentially.  It refuses (returns false) for files below MMAP_THRESHOLD
+ * and for anything that cannot be mapped (pipes, devices, /proc), so the
+ * caller keeps its iostream path for those.
+ */
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    /** @return true if `path` is now mapped; false means "use the fallback". */
+    bool open(const std::string& path);
+
+    const uint8_t* data() const { return data_; }
+    std::size_t    size() const { return size_; }
+
+private:
+    const uint8_t* data_ = nullptr;
+    std::size_t    size_ = 0;
+};
+
+/**
+ * @brief Output file written with large write(2) calls.
+ *
+ * Small appends are staged in a WRITE_BUFFER_SIZE buffer; appends at least
+ * that large go straight from the caller's memory to the kernel.  A size
+ * hint from preallocate() reserves the blocks up front (posix_fallocate),
+ * and close() trims the file to the bytes actually written.
+ */
+class FileWriter : public ByteSink {
+public:
+    FileWriter() = default;
+    ~FileWriter() override;
+
+    FileWriter(const FileWriter&)            = delete;
+    FileWriter& operator=(const FileWriter&) = delete;
+
+    /** @brief Create or truncate `path`; false if it cannot be opened. */
+    bool open(const std::string& path);
+
+    bool write(const void* data, std::size_t size) override;
+    bool flush() override;
+    void preallocate(uint64_t bytes) override;
+
+    /** @brief Flush, trim and close; false if any write failed. */
+    bool close();
+
+private:
+    bool writeAll(const uint8_t* data, std::size_t size);
+
+    int                  fd_ = -1;
+    bool                 ok_ = true;
+    uint64_t             written_     = 0;   ///< bytes handed to the kernel
+    uint64_t             preallocated_ = 0;
+    std::vector<uint8_t> buffer_;
+};
+
+/**
+ * @brief Input file read ahead by a background thread with pread(2).
+ *
+ * After start() the reader thread fills a ring of PIPELINE_DEPTH
+ * segments while the caller works on earlier ones; it blocks when the ring
+ * is full, so memory stays at depth × segmentSize.  next() hands segments
+ * over by swapping buffers, and the buffer it gets back is reused.
+ * open() refuses what pread cannot serve (pipes, devices), so the caller
+ * keeps its iostream path for those.
+ */
+class ReadAhead {
+public:
+    ReadAhead() = default;
+    ~ReadAhead();
+
+    ReadAhead(const ReadAhead&)            = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+
+    /** @return true if `path` is an open regular file. */
+    bool open(const std::string& path);
+
+    uint64_t size() const { return size_; }
+
+    /** @brief Synchronous pread of exactly `n` bytes at `pos`; only before start(). */
+    bool readAt(uint64_t pos, void* dst, std::size_t n) const;
+
+    /** @brief Start reading the whole file, `segmentSize` bytes at a time. */
+    void start(std::size_t segmentSize);
+
+    /**
+     * @brief Swap the next segment (in file order) into `segment`.
+     * @return false at the end of the file or after a read error.
+     */
+    bool next(std::vector<uint8_t>& segment);
+
+    /** @brief A read failed (next() returned false early). */
+    bool failed() const;
+
+private:
+    void readerLoop(std::size_t segmentSize);
+
+    int                              fd_   = -1;
+    uint64_t                         size_ = 0;
+    std::thread                      reader_;
+    mutable std::mutex               mutex_;
+    std::condition_variable          changed_;
+    std::deque<std::vector<uint8_t>> ready_;   ///< filled, in file order
+    std::vector<std::vector<uint8_t>> spare_;  ///< returned by next(), for reuse
+    bool                             done_     = false;   ///< no more segments
+    bool                             failed_   = false;
+    bool                             stopping_ = false;
+};
+
+/**
+ * @brief ByteSink that hands whole buffers to a writer thread.
+ *
+ * write() only copies into the current WRITE_BUFFER_SIZE buffer; full
+ * buffers are queued for the writer thread, which passes them on to the
+ * wrapped sink.  At most PIPELINE_DEPTH buffers wait in the queue, and
+ * write() blocks beyond that.  flush() waits until everything reached the
+ * wrapped sink and flushes it.  A write error is reported by the next
+ * write() or flush().
+ */
+class AsyncWriter : public ByteSink {
+public:
+    explicit AsyncWriter(ByteSink& out);
+    ~AsyncWriter() override;
+
+    AsyncWriter(const AsyncWriter&)            = delete;
+    AsyncWriter& operator=(const AsyncWriter&) = delete;
+
+    bool write(const void* data, std::size_t size) override;
+    bool flush() override;
+    void preallocate(uint64_t bytes) override;
+
+private:
+    void writerLoop();
+    void queueCurrent();
+    void waitIdle(std::unique_lock<std::mutex>& lock);
+
+    ByteSink&                         out_;
+    std::vector<uint8_t>              current_;
+    std::thread                       writer_;
+    std::mutex                        mutex_;
+    std::condition_variable           changed_;
+    std::deque<std::vector<uint8_t>>  queue_;
+    std::vector<std::vector<uint8_t>> spare_;
+    bool                              busy_     = false;   ///< writer holds a buffer
+    bool                              ok_       = true;
+    bool                              stopping_ = false;
+};
+
+}  // namespace util
+}  // namespace huffman
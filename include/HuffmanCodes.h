@@ -1,14 +1,45 @@
 #pragma once
-#include <unordered_map>
-#include <string>
+#include <array>
+#include <cstdint>
 #include "HuffmanNode.h"
 
 /**
- * @brief Genera los códigos binarios para cada carácter del árbol de Huffman.
+ * @brief Código de Huffman de un símbolo en forma numérica.
  *
- * @param root Puntero a la raíz del árbol de Huffman.
- * @return std::unordered_map<char, std::string> Mapa de (carácter -> código binario).
+ * `bits` guarda el código alineado a la derecha (el primer bit emitido es el
+ * más significativo de los `len` bits).  `len == 0` indica símbolo ausente.
  */
+struct Code {
+    uint64_t bits = 0;
+    uint8_t  len  = 0;
+};
 
+/** @brief Tabla densa de códigos indexada por byte (0..255). */
+using CodeTable = std::array<Code, 256>;
 
- std::unordered_map<char, std::string> generateHuffmanCodes(HuffmanNode* root);
+/** @brief Longitud de código por byte (0 = símbolo ausente). */
+using CodeLengths = std::array<uint8_t, 256>;
+
+/**
+ * @brief Genera el código de cada byte siguiendo los caminos del árbol.
+ *
+ * Izquierda = 0, derecha = 1; no reserva memoria ni construye cadenas.  Un
+ * árbol de una sola hoja recibe el código "0" (longitud 1), igual que en
+ * buildCodeLengths().  Requiere profundidad <= 64.
+ *
+ * @param tree Árbol de Huffman.
+ * @return CodeTable Patrón de bits y longitud por byte (len 0 = ausente).
+ */
+CodeTable generateHuffmanCodes(const HuffmanTree& tree);
+
+/**
+ * @brief Asigna códigos canónicos a partir de las longitudes.
+ *
+ * Los símbolos se ordenan por (longitud, byte) y reciben códigos consecutivos,
+ * así que las longitudes bastan para que el decodificador reconstruya la
+ * tabla exacta sin árbol.
+ *
+ * @param lengths Longitud de código de cada byte (0 = ausente).
+ * @return CodeTable Tabla de códigos canónicos.
+ */
+CodeTable canonicalCodes(const CodeLengths& lengths);
@@ -1,12 +1,157 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
+#include <vector>
 #include "HuffmanNode.h"
+#include "HuffmanEncoder.h"   // Code, CodeTable
+#include "BitReader.h"
 
 /**
  * @brief Decodifica un texto binario (string de '0' y '1') usando el árbol de Huffman.
  *
+ * Versión didáctica (un puntero por bit); la descompresión real usa DecodeTable.
+ * Si el árbol tiene un nodo interno sin alguno de sus hijos, se detiene ahí
+ * y devuelve lo decodificado hasta entonces.
+ *
  * @param encoded Texto codificado que consiste en una secuencia de bits ('0' y '1')
- * @param root Nodo raíz del árbol de Huffman.
+ * @param tree Árbol de Huffman.
  * @return std::string Texto original decodificado.
  */
-std::string decodeText(const std::string& encoded, HuffmanNode* root);
+std::string decodeText(const std::string& encoded, const HuffmanTree& tree);
+
+/**
+ * @brief Decodificador por tablas: resuelve un símbolo por consulta.
+ *
+ * La tabla raíz se indexa con los próximos `rootBits` bits (hasta TABLE_BITS)
+ * y da directamente símbolo + longitud.  Los códigos más largos que la raíz
+ * apuntan a sub-tablas de segundo nivel (y siguientes, si hiciera falta).
+ *
+ * Si todos los códigos caben en la raíz, build() fija su ancho en 8, 11 o
+ * 12 bits según el código más largo y decode() usa un núcleo compilado para
+ * ese ancho: desplazamientos constantes y 56 / ancho símbolos por refill
+ * (7, 5 o 4) desenrollados por completo.
+ *
+ * Opcionalmente (build(codes, true)) se añade una tabla multi-símbolo del
+ * mismo ancho: cada entrada guarda hasta MULTI_SYMBOLS símbolos cuyos
+ * códigos juntos caben en la raíz, así que con códigos cortos una consulta
+ * emite varios bytes.  Cuesta 2^ancho pasos construirla, por eso sólo
+ * compensa en bloques de al menos MULTI_MIN_SYMBOLS símbolos.
+ */
+class DecodeTable {
+public:
+    static constexpr unsigned TABLE_BITS = 12;
+
+    /** @brief Sub-flujos que decode4() avanza a la vez. */
+    static constexpr unsigned STREAMS = 4;
+
+    /** @brief Máximo de símbolos por entrada de la tabla multi-símbolo. */
+    static constexpr unsigned MULTI_SYMBOLS = 4;
+
+    /** @brief Bloque mínimo con el que conviene pedir la tabla multi-símbolo. */
+    static constexpr std::size_t MULTI_MIN_SYMBOLS = 32 * 1024;
+
+    /**
+     * @brief Construye las tablas a partir de los códigos de cada símbolo.
+     *
+     * Reconstruir sobre el mismo objeto reutiliza su memoria.
+     *
+     * @param codes       Tabla de códigos (la misma que usó el codificador).
+     * @param multiSymbol Construir también la tabla multi-símbolo; se omite
+     *                    si hay sub-tablas o si ningún par de códigos cabe
+     *                    en la raíz.
+     * @return false si los códigos no forman un código prefijo válido.
+     */
+    bool build(const CodeTable& codes, bool multiSymbol = false);
+
+    /** @brief true si build() dejó lista la tabla multi-símbolo. */
+    bool multiSymbol() const { return !multi_.empty(); }
+
+    /**
+     * @brief Decodifica `count` símbolos del flujo de bits.
+     *
+     * @param in    Lector posicionado al inicio del payload.
+     * @param out   Destino con espacio para `count` bytes.
+     * @param count Número de símbolos a emitir.
+     * @return false si aparece un patrón de bits sin código asignado.
+     */
+    bool decode(BitReader& in, uint8_t* out, std::size_t count) const;
+
+    /**
+     * @brief Decodifica cuatro sub-flujos independientes intercalando las consultas.
+     *
+     * El bloque de `count` símbolos se reparte en segmentos contiguos de
+     * segmentSize(count) símbolos (el último puede ser más corto o vacío) y
+     * `in[k]` lleva el segmento k.  Las cuatro cadenas de dependencias
+     * (longitud -> siguiente consulta) avanzan en paralelo dentro del núcleo.
+     *
+     * @param in    Un lector por segmento.
+     * @param out   Destino con espacio para `count` bytes.
+     * @param count Número total de símbolos.
+     * @return false si algún flujo tiene un patrón sin código asignado.
+     */
+    bool decode4(BitReader (&in)[STREAMS], uint8_t* out, std::size_t count) const;
+
+    /** @brief Símbolos por segmento en el formato de cuatro flujos. */
+    static std::size_t segmentSize(std::size_t count) { return (count + STREAMS - 1) / STREAMS; }
+
+private:
+    enum Kind : uint8_t { EMPTY = 0, LEAF, SUB };
+
+    /** @brief Núcleo de decode(): GENERAL recorre sub-tablas, ROOTn no las tiene. */
+    enum Kernel : uint8_t { GENERAL, ROOT8, ROOT11, ROOT12 };
+
+    /** @brief Entrada de tabla: hoja (símbolo) o enlace a sub-tabla. */
+    struct Entry {
+        uint32_t value   = 0;      ///< símbolo (LEAF) u offset de la sub-tabla (SUB)
+        uint8_t  len     = 0;      ///< bits a consumir en este nivel
+        uint8_t  kind    = EMPTY;
+        uint8_t  subBits = 0;      ///< ancho de la sub-tabla (SUB)
+    };
+
+    /** @brief Entrada multi-símbolo: `count` bytes listos para copiar de una vez. */
+    struct MultiEntry {
+        uint8_t symbols[MULTI_SYMBOLS] = {};
+        uint8_t len   = 0;   ///< bits de todos los códigos juntos (<= rootBits_)
+        uint8_t count = 0;   ///< 0: patrón sin código asignado
+    };
+
+    /** @brief Código pendiente de colocar: patrón, longitud y símbolo. */
+    struct Pending {
+        uint64_t bits;
+        unsigned len;
+        uint8_t  symbol;
+    };
+
+    bool fill(std::size_t offset, unsigned width, unsigned depth,
+              const Pending* first, const Pending* last);
+
+    /** @brief Núcleo sin sub-tablas; devuelve los símbolos decodificados. */
+    template <unsigned RootBits>
+    std::size_t decodeFast(BitReader& in, uint8_t* out, std::size_t count, bool& ok) const;
+
+    /** @brief Ídem para los cuatro flujos; avanza los cuatro segmentos a la vez. */
+    template <unsigned RootBits>
+    std::size_t decode4Fast(BitReader (&in)[STREAMS], uint8_t* const (&dst)[STREAMS],
+                            std::size_t len, bool& ok) const;
+
+    /** @brief Núcleo multi-símbolo; copia MULTI_SYMBOLS bytes por consulta. */
+    template <unsigned RootBits>
+    std::size_t decodeMulti(BitReader& in, uint8_t* out, std::size_t count, bool& ok) const;
+
+    /** @brief Ídem para los cuatro flujos; `done[k]` avanza por separado. */
+    template <unsigned RootBits>
+    void decode4Multi(BitReader (&in)[STREAMS], uint8_t* const (&dst)[STREAMS],
+                      const std::size_t (&len)[STREAMS], std::size_t (&done)[STREAMS],
+                      bool& ok) const;
+
+    void buildMulti();
+
+    std::vector<Entry>      entries_;   ///< raíz en [0, 2^rootBits_), sub-tablas después
+    std::vector<MultiEntry> multi_;     ///< 2^rootBits_ entradas, o vacía
+    std::vector<Pending>    pending_;   ///< códigos de build(); se conserva la reserva
+    unsigned rootBits_ = 1;
+    unsigned minLen_   = 0;
+    unsigned maxLen_   = 0;
+    Kernel   kernel_   = GENERAL;
+};
@@ -1,12 +1,54 @@
 #pragma once
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <unordered_map>
+#include "BitWriter.h"
+#include "HuffmanCodes.h"   // Code, CodeTable
+#include "frequency.h"      // Histogram
 
 /**
- * @brief Codifica un texto usando un mapa de códigos de Huffman.
+ * @brief Calcula cuántos bits ocupará la salida codificada.
  *
- * @param text Texto original a codificar.
- * @param codes Mapa (carácter -> código binario) generado previamente.
+ * @param hist  Frecuencia de cada byte del texto.
+ * @param table   Tabla de códigos.
+ * @return uint64_t Total de bits (suma de frecuencia × longitud).
+ */
+uint64_t encodedBitCount(const Histogram& hist, const CodeTable& table);
+
+/**
+ * @brief Codifica un texto directamente a bits empaquetados.
+ *
+ * @param text  Texto original a codificar.
+ * @param table Tabla de códigos; todos los caracteres de `text` deben tener código.
+ * @param out   Escritor de bits destino (el llamador invoca finish()).
+ */
+void encodePacked(const std::string& text, const CodeTable& table, BitWriter& out);
+
+/**
+ * @brief Igual que la versión con std::string, sobre un buffer de bytes.
+ *
+ * @param data  Bytes a codificar.
+ * @param size  Número de bytes.
+ * @param table Tabla de códigos; todos los bytes deben tener código.
+ * @param out   Escritor de bits destino (el llamador invoca finish()).
+ */
+void encodePacked(const uint8_t* data, std::size_t size,
+                  const CodeTable& table, BitWriter& out);
+
+/**
+ * @brief Codifica un texto usando una tabla de códigos de Huffman.
+ *
+ * Versión didáctica: produce un byte '0'/'1' por bit.  Sólo la usa la demo;
+ * la compresión real usa encodePacked().
+ *
+ * @param text  Texto original a codificar.
+ * @param table Tabla generada por generateHuffmanCodes() o canonicalCodes().
  * @return std::string Cadena de bits representando el texto codificado.
+ * @throws std::out_of_range si algún carácter no tiene código.
+ */
+std::string encodeText(const std::string& text, const CodeTable& table);
+
+/**
+ * @brief Representa un código como texto ("0101..."), para mostrarlo.
  */
-std::string encodeText(const std::string& text, const std::unordered_map<char, std::string>& codes);
+std::string codeToString(const Code& code);
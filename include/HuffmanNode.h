@@ -1,23 +1,67 @@
 #pragma once
 #include <cstddef>
+#include <cstdint>
+#include <vector>
 
 /**
  * @brief Estructura para representar un nodo del árbol de Huffman.
  *
- * Contiene el carácter (character), la frecuencia (frequency) y punteros
- * a los hijos izquierdo (left) y derecho (right).
+ * Contiene el carácter (character), la frecuencia (frequency) y los índices
+ * de los hijos izquierdo (left) y derecho (right) dentro de HuffmanTree::nodes.
+ * Las hojas tienen ambos hijos a HuffmanTree::NIL.
  */
 struct HuffmanNode {
-   char character;
-   int frequency;
-   HuffmanNode* left;
-   HuffmanNode* right;
+   uint64_t frequency;
+   uint16_t left;
+   uint16_t right;
+   char     character;
+
+   bool isLeaf() const;
+};
+
+/**
+ * @brief Árbol de Huffman almacenado en un arreglo contiguo (arena).
+ *
+ * Los nodos se añaden en orden de creación, así que todo hijo tiene un índice
+ * menor que su padre y la raíz es el último nodo.  Con 256 símbolos hay como
+ * mucho 511 nodos: bastan índices de 16 bits.  clear() conserva la reserva, de
+ * modo que reconstruir sobre el mismo objeto no vuelve a pedir memoria.
+ */
+struct HuffmanTree {
+   static constexpr uint16_t NIL = 0xFFFF;
+
+   std::vector<HuffmanNode> nodes;
+   uint16_t root = NIL;
+
+   bool empty() const { return root == NIL; }
+
+   /** @brief Vacía el árbol sin liberar la reserva de nodos. */
+   void clear()
+   {
+      nodes.clear();
+      root = NIL;
+   }
+
+   const HuffmanNode& operator[](uint16_t i) const { return nodes[i]; }
+
+   /** @brief Añade una hoja y devuelve su índice. */
+   uint16_t addLeaf(char c, uint64_t freq)
+   {
+      nodes.push_back({ freq, NIL, NIL, c });
+      return static_cast<uint16_t>(nodes.size() - 1);
+   }
 
    /**
-    * @brief Contructor que inicializa el nodo con un carácter y su frecuencia.
+    * @brief Añade un nodo interno que une `left` y `right`.
     *
-    * Para nodos internos del árbol (combinación de dos subárboles),
-    * se suele usar un carácter centinela (por ejemplo, '\0').
+    * Para nodos internos se usa el carácter centinela '\0'.
     */
-   HuffmanNode(char c, int freq) : character(c), frequency(freq), left(nullptr), right(nullptr) {}
+   uint16_t addParent(uint16_t left, uint16_t right)
+   {
+      uint64_t freq = nodes[left].frequency + nodes[right].frequency;
+      nodes.push_back({ freq, left, right, '\0' });
+      return static_cast<uint16_t>(nodes.size() - 1);
+   }
 };
+
+inline bool HuffmanNode::isLeaf() const { return left == HuffmanTree::NIL; }
@@ -1,13 +1,51 @@
 #pragma once
-#include <unordered_map>
-#include <queue>
+#include <cstdint>
+#include <utility>
 #include <vector>
 #include "HuffmanNode.h"
+#include "HuffmanCodes.h"   // CodeLengths
+#include "frequency.h"      // Histogram
 
 /**
- * @brief Construye el árbol de Huffman a partir de un mapa de frecuencias.
+ * @brief Construye el árbol de Huffman a partir de un histograma.
  *
- * @param freqMap Mapa de frecuencias, donde la clave es el carácter y el valor es la frecuencia.
- * @return HuffanNode* Puntero al nodo raíz del árbol de Huffman.
+ * Ordena una vez los símbolos presentes por frecuencia (en empate, por valor
+ * de byte) y los fusiona con el método lineal de dos colas, sin heap.  El
+ * árbol se reconstruye dentro de `tree`, reutilizando su reserva.
+ *
+ * @param hist Frecuencia de cada byte.
+ * @param tree Árbol destino (queda vacío si no hay símbolos).
+ */
+void buildHuffmanTree(const Histogram& hist, HuffmanTree& tree);
+
+/**
+ * @brief Igual que la versión con histograma, pero con las hojas en un orden explícito.
+ *
+ * Los empates de frecuencia entre hojas se rompen según la posición en
+ * `leaves`, y entre hoja y nodo interno gana la hoja; así la misma secuencia
+ * produce siempre el mismo árbol (lo necesita el lector HUF0, que
+ * reconstruye el árbol en el orden en que la tabla aparece en el archivo).
+ *
+ * @param leaves Pares (carácter, frecuencia) en el orden de inserción deseado.
+ * @param tree   Árbol destino (queda vacío si `leaves` está vacío).
+ */
+void buildHuffmanTree(const std::vector<std::pair<char, uint64_t>>& leaves,
+                      HuffmanTree& tree);
+
+/**
+ * @brief Calcula la longitud de código de cada símbolo, limitada a `maxLen`.
+ *
+ * Primero construye el árbol de Huffman sin límite; si su profundidad no
+ * supera `maxLen` esas longitudes ya son óptimas.  Si la supera, recalcula
+ * con package-merge, que da el código prefijo óptimo de longitud acotada.
+ * `maxLen` se eleva si no alcanza para el alfabeto (2^maxLen >= símbolos).
+ * Un único símbolo recibe longitud 1.
+ *
+ * @param hist        Frecuencia de cada byte.
+ * @param maxLen      Longitud máxima permitida.
+ * @param optimalBits Si no es nulo, recibe los bits que ocuparía la salida
+ *                    con el código de Huffman sin límite.
+ * @return CodeLengths Longitud por byte (0 = ausente).
  */
-HuffmanNode* buildHuffmanTree(const std::unordered_map<char, int>& freqMap);
+CodeLengths buildCodeLengths(const Histogram& hist, unsigned maxLen,
+                             uint64_t* optimalBits = nullptr);
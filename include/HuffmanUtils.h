@@ -1,23 +1,21 @@
 #pragma once
 #include "HuffmanNode.h"
+#include "frequency.h"      // Histogram
+#include "CompressedIO.h"   // huffman::util::Stats
+#include <iostream>
 #include <string>
-#include <unordered_map>
 
 /**
- * @brief Libera la memoria de un árbol de Huffman.
+ * @brief Imprime los contadores y tiempos por etapa de una compresión o
+ *        descompresión.
  *
- * @param node Puntero al nodo de raíz del árbol.
- */
-void deleteTree(HuffmanNode* node);
-
-
-/**
- * @brief Muestra estadísticas de compresión entre el texto original y codificado.
+ * Sólo aparecen las etapas y tipos de bloque con algo que contar; el
+ * rendimiento se da sobre los bytes de entrada y de salida.
  *
- * @param original Texto original sin comprimir.
- * @param encoded Texto codificado (en forma de string de bits).
+ * @param stats Resultado de la llamada instrumentada.
+ * @param out   Destino (stderr cuando stdout lleva los datos).
  */
-void reportCompressionStats(const std::string& original, const std::string& encoded);
+void printStats(const huffman::util::Stats& stats, std::ostream& out = std::cout);
 
 
 /**
@@ -33,16 +31,16 @@ void reportCompressionStats(const std::string& original, const std::string& enco
  *                   /  \
  *              ('c',1) ('d',1)
  *
- * @param root Puntero a la raíz del árbol.
+ * @param tree Árbol de Huffman.
  */
-void printHuffmanTreePretty(const HuffmanNode* root);
+void printHuffmanTreePretty(const HuffmanTree& tree);
 
 
 /**
  * @brief Imprime un histograma ASCII a color con las frecuencias de caracteres.
- * @param freqMap Mapa (carácter -> frecuencia).
+ * @param hist Frecuencia de cada byte (sólo se muestran los presentes).
  */
-void printFrequencyHistogram(const std::unordered_map<char,int>& freqMap);
+void printFrequencyHistogram(const Histogram& hist);
 
 
 /**
@@ -65,8 +63,8 @@ void writeBitStringToFile(const std::string& path, const std::string& bits);
  * @brief Export a Huffman tree to a Graphviz DOT file.
  *        If you later run `dot -Tsvg tree.dot -o tree.svg`, you get an SVG.
  *
- * @param root     Pointer to the tree root.
+ * @param tree     Huffman tree (node ids are the array indices).
  * @param dotPath  Path of the DOT file to generate.
  */
-void exportTreeToDot(const HuffmanNode* root,
+void exportTreeToDot(const HuffmanTree& tree,
                      const std::string& dotPath);
@@ -0,0 +1,62 @@
+#pragma once
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace huffman {
+
+/**
+ * @brief Fixed-size pool of worker threads fed from a FIFO task queue.
+ *
+ * submit() returns a std::future for the task's result; exceptions thrown by
+ * the task are delivered through that future.  The destructor finishes the
+ * queued tasks before joining the workers.
+ */
+class ThreadPool {
+public:
+    /** @param threads Number of workers (0 = std::thread::hardware_concurrency()). */
+    explicit ThreadPool(unsigned threads);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /** @brief Queue `fn` (callable with no arguments; may be move-only). */
+    template <typename Fn>
+    auto submit(Fn fn) -> std::future<std::invoke_result_t<Fn&>>
+    {
+        using Result = std::invoke_result_t<Fn&>;
+        auto task = std::make_shared<std::packaged_task<Result()>>(std::move(fn));
+        std::future<Result> result = task->get_future();
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            tasks_.emplace_back([task] { (*task)(); });
+        }
+        ready_.notify_one();
+        return result;
+    }
+
+    /** @brief Number of worker threads. */
+    unsigned size() const { return static_cast<unsigned>(workers_.size()); }
+
+    /** @brief Resolve a user-facing thread count (0 = all hardware threads). */
+    static unsigned resolve(unsigned threads);
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread>          workers_;
+    std::deque<std::function<void()>> tasks_;
+    std::mutex                        mutex_;
+    std::condition_variable           ready_;
+    bool                              stopping_ = false;
+};
+
+}  // namespace huffman
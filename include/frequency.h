@@ -1,11 +1,31 @@
 #pragma once
-#include <unordered_map>
+#include <array>
+#include <cstddef>
+#include <cstdint>
 #include <string>
 
+/** @brief Histograma denso: cantidad de apariciones de cada byte (0..255). */
+using Histogram = std::array<uint64_t, 256>;
+
+/**
+ * @brief Cuenta las apariciones de cada byte de un buffer.
+ *
+ * Usa cuatro sub-histogramas intercalados para que bytes repetidos seguidos
+ * no encadenen store→load sobre el mismo contador.  Con `threads` > 1 y un
+ * buffer grande, el trabajo se reparte en tramos contiguos por hilo.
+ *
+ * @param data    Bytes de entrada.
+ * @param size    Número de bytes.
+ * @param threads Hilos a usar (1 = sin hilos, 0 = todos los núcleos).
+ * @return Histogram Cuenta de cada byte.
+ */
+Histogram computeHistogram(const uint8_t* data, std::size_t size,
+                           unsigned threads = 1);
+
 /**
  * @brief Calcula la frecuencia de cada carácter en un texto.
  *
  * @param text Cadena de entrada.
- * @return std::unordered_map<char, int> Mapa con frecuencias (carácter -> cantidad de apariciones).
+ * @return Histogram Cuenta de cada byte (índice = carácter como unsigned char).
  */
-std::unordered_map<char, int> computeFrequencies(const std::string& text);
+Histogram computeFrequencies(const std::string& text);
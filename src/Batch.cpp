@@ -0,0 +1,89 @@
+#include "Batch.h"
+#include "ThreadPool.h"
+
+#include <chrono>
+#include <filesystem>
+#include <future>
+
+using namespace huffman;
+using namespace huffman::util;
+
+namespace fs = std::filesystem;
+
+/** @brief Check the paths of `file`, then run `codec` on them. */
+template <typename Codec>
+static void processFile(BatchFile& file, Codec codec)
+{
+    std::error_code ec;
+    if (!fs::is_regular_file(file.input, ec)) {
+        file.error = "not a readable file";
+        return;
+    }
+    fs::path parent = fs::path(file.output).parent_path();
+    if (!parent.empty() && !fs::create_directories(parent, ec) && ec) {
+        file.error = "cannot create " + parent.string();
+        return;
+    }
+    file.ok = codec(file);
+}
+
+/**
+ * @brief Run `codec` over all files on a pool and collect the totals.
+ *
+ * Every task writes only its own BatchFile, so the list needs no lock;
+ * the futures are drained in list order to report each file as it ends.
+ */
+template <typename Codec>
+static BatchReport runBatch(std::vector<BatchFile>& files, unsigned workers,
+                            const BatchCallback& done, Codec codec)
+{
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+
+    ThreadPool pool(workers);
+    std::vector<std::future<void>> pending;
+    pending.reserve(files.size());
+    for (BatchFile& file : files)
+        pending.push_back(pool.submit([&file, &codec] { processFile(file, codec); }));
+
+    BatchReport report;
+    for (std::size_t i = 0; i < files.size(); ++i) {
+        pending[i].get();
+        const BatchFile& file = files[i];
+        ++report.files;
+        if (file.ok) {
+            report.inputBytes  += file.stats.inputBytes;
+            report.outputBytes += file.stats.outputBytes;
+        } else {
+            ++report.failed;
+        }
+        if (done) done(file);
+    }
+    report.totalNs = static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    return report;
+}
+
+BatchReport util::compressBatch(std::vector<BatchFile>& files, const CompressOptions& options,
+                                unsigned workers, const BatchCallback& done)
+{
+    return runBatch(files, workers, done, [&options](BatchFile& file) {
+        CompressOptions one = options;
+        one.threads = 1;
+        one.stats   = &file.stats;
+        if (writeCompressedFile(file.input, file.output, one)) return true;
+        file.error = "compression failed";
+        return false;
+    });
+}
+
+BatchReport util::decompressBatch(std::vector<BatchFile>& files, unsigned workers,
+                                  const Dictionary* dictionary, const BatchCallback& done)
+{
+    return runBatch(files, workers, done, [dictionary](BatchFile& file) {
+        if (readCompressedFile(file.input, file.output, 1, dictionary, &file.stats))
+            return true;
+        file.error = "decompression failed (corrupt file?)";
+        return false;
+    });
+}
@@ -0,0 +1,493 @@
+#include "BlockCodec.h"
+#include "Checksum.h"
+#include "Dictionary.h"
+#include "HuffmanTree.h"      // buildCodeLengths()
+#include "HuffmanEncoder.h"   // encodePacked()
+#include "BitWriter.h"
+#include "BitReader.h"
+#include "frequency.h"        // computeHistogram()
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>             // std::log2
+#include <cstring>           // std::memcpy, std::memcmp, std::memset
+
+using namespace huffman;
+
+/* ------------------------------------------------------------------ */
+/*  Little-endian helpers                                             */
+/* ------------------------------------------------------------------ */
+
+static void putU16(std::vector<uint8_t>& out, uint16_t v)
+{
+    out.push_back(uint8_t(v));
+    out.push_back(uint8_t(v >> 8));
+}
+
+static void putU32(std::vector<uint8_t>& out, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) out.push_back(uint8_t(v >> (8 * i)));
+}
+
+static void setU32(uint8_t* p, uint32_t v)
+{
+    for (int i = 0; i < 4; ++i) p[i] = uint8_t(v >> (8 * i));
+}
+
+static uint32_t getU32(const uint8_t* p)
+{
+    return uint32_t(p[0]) | uint32_t(p[1]) << 8 |
+           uint32_t(p[2]) << 16 | uint32_t(p[3]) << 24;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Code-length tables                                                */
+/* ------------------------------------------------------------------ */
+
+void huffman::appendCodeLengths(std::vector<uint8_t>& out, const CodeLengths& lengths)
+{
+    uint16_t count = 0;
+    for (unsigned s = 0; s < lengths.size(); ++s)
+        if (lengths[s]) count = static_cast<uint16_t>(s + 1);
+
+    putU16(out, count);
+    std::size_t base = out.size();
+    out.resize(base + (count + 1) / 2, 0);
+    for (unsigned s = 0; s < count; ++s)
+        out[base + s / 2] |= uint8_t(lengths[s] << (s % 2 ? 0 : 4));
+}
+
+std::size_t huffman::parseCodeLengths(const uint8_t* src, std::size_t size,
+                                      CodeLengths& lengths)
+{
+    if (size < 2) return 0;
+    unsigned count = unsigned(src[0]) | unsigned(src[1]) << 8;
+    std::size_t bytes = 2 + (count + 1) / 2;
+    if (count > 256 || size < bytes) return 0;
+
+    lengths.fill(0);
+    for (unsigned s = 0; s < count; ++s)
+        lengths[s] = (src[2 + s / 2] >> (s % 2 ? 0 : 4)) & 0x0F;
+    return bytes;
+}
+
+bool huffman::frameChecksum(const uint8_t* body, std::size_t size, uint32_t& crc)
+{
+    if (size < CHECKSUM_BLOCK_SIZE || body[0] != BLOCK_CHECKSUM) return false;
+    crc = getU32(body + 1);
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Block encoder                                                     */
+/* ------------------------------------------------------------------ */
+
+void BlockEncoder::setMaxCodeLen(unsigned maxCodeLen)
+{
+    maxCodeLen_ = std::clamp(maxCodeLen, 1u, MAX_STORED_CODE_LEN);
+}
+
+void BlockEncoder::setStreams(unsigned streams)
+{
+    streams_ = streams >= DecodeTable::STREAMS ? DecodeTable::STREAMS : 1;
+}
+
+BlockStats& BlockStats::operator+=(const BlockStats& other)
+{
+    payloadBits += other.payloadBits;
+    optimalBits += other.optimalBits;
+    codedBytes  += other.codedBytes;
+    codedBits   += other.codedBits;
+    maxCodeLen   = std::max(maxCodeLen, other.maxCodeLen);
+    for (unsigned t = 0; t < BLOCK_TYPES; ++t) blocks[t] += other.blocks[t];
+    histogramNs += other.histogramNs;
+    treeNs      += other.treeNs;
+    encodeNs    += other.encodeNs;
+    return *this;
+}
+
+BlockStats BlockEncoder::encode(const uint8_t* data, std::size_t size,
+                                std::vector<uint8_t>& out)
+{
+    BlockStats stats;
+    prevLengths_ = nullptr;   // a frame must decode on its own
+    prevTable_   = nullptr;
+    runAt_       = NO_RUN;
+
+    const std::size_t step = subBlockSize_ ? subBlockSize_ : size;
+
+    /* No block is larger than its raw copy plus a small header: reserve once */
+    const std::size_t blocks = step ? (size + step - 1) / step : 1;
+    out.reserve(out.size() + size + 32 * blocks + CHECKSUM_BLOCK_SIZE);
+
+    /* Checksum first, filled in at the end */
+    const std::size_t checkAt = out.size();
+    if (checksum_) {
+        out.push_back(BLOCK_CHECKSUM);
+        putU32(out, 0);
+        ++stats.blocks[BLOCK_CHECKSUM];
+    }
+
+    uint32_t    crc = 0;
+    std::size_t pos = 0;
+    do {
+        std::size_t n = std::min(step, size - pos);
+        encodeBlock(data + pos, n, out, stats);
+        if (checksum_) crc = crc32c(crc, data + pos, n);   // block still in cache
+        pos += n;
+    } while (pos < size);
+
+    if (checksum_) setU32(out.data() + checkAt + 1, crc);
+    return stats;
+}
+
+/** @brief Bits to code `hist` with `lengths`, or UINT64_MAX if a byte has no code. */
+static uint64_t bitsWith(const Histogram& hist, const CodeLengths& lengths)
+{
+    uint64_t bits = 0;
+    for (unsigned s = 0; s < hist.size(); ++s) {
+        if (!hist[s]) continue;
+        if (!lengths[s]) return UINT64_MAX;
+        bits += hist[s] * lengths[s];
+    }
+    return bits;
+}
+
+/**
+ * @brief True if all `size` (> 0) bytes are equal.
+ *
+ * Comparing the block with itself shifted by one stops at the first change,
+ * so ordinary data is rejected within a few bytes.
+ */
+static bool isRun(const uint8_t* data, std::size_t size)
+{
+    return std::memcmp(data, data + 1, size - 1) == 0;
+}
+
+/**
+ * @brief Lower bound, in bits, for any prefix code of `hist` (Shannon entropy).
+ *
+ * Neither a new nor a reused table can do better, so when this is already
+ * no smaller than the stored bytes the tree need not be built at all.
+ */
+static double entropyBits(const Histogram& hist, std::size_t size)
+{
+    double bits = 0;
+    for (uint64_t count : hist)
+        if (count) bits -= double(count) * std::log2(double(count) / double(size));
+    return bits;
+}
+
+uint64_t BlockEncoder::writeRun(uint8_t symbol, std::size_t size, std::vector<uint8_t>& out)
+{
+    /* The previous block is a run of the same byte: just lengthen it */
+    if (runAt_ != NO_RUN && out[runAt_ + 5] == symbol) {
+        uint64_t total = uint64_t(getU32(out.data() + runAt_ + 1)) + size;
+        if (total <= UINT32_MAX) {
+            setU32(out.data() + runAt_ + 1, static_cast<uint32_t>(total));
+            return 0;
+        }
+    }
+    runAt_ = out.size();
+    out.push_back(BLOCK_RLE);
+    putU32(out, static_cast<uint32_t>(size));
+    out.push_back(symbol);
+    return 8;
+}
+
+/** @brief Bytes of a Huffman payload of `bits` plus `fields`, or UINT64_MAX. */
+static uint64_t payloadBytes(uint64_t bits, uint64_t fields)
+{
+    return bits == UINT64_MAX ? UINT64_MAX : (bits + 7) / 8 + fields;
+}
+
+/** @brief Longest code among the bytes present in `hist`. */
+static unsigned longestUsed(const Histogram& hist, const CodeLengths& lengths)
+{
+    unsigned longest = 0;
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s]) longest = std::max<unsigned>(longest, lengths[s]);
+    return longest;
+}
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+void BlockEncoder::encodeBlock(const uint8_t* data, std::size_t size,
+                               std::vector<uint8_t>& out, BlockStats& stats)
+{
+    const bool interleaved = streams_ > 1 && size >= MIN_INTERLEAVED_SIZE;
+
+    /* Charge the time since the previous lap to `slot` */
+    uint64_t mark = timing_ ? nowNs() : 0;
+    auto lap = [&](uint64_t& slot) {
+        if (!timing_) return;
+        uint64_t now = nowNs();
+        slot += now - mark;
+        mark  = now;
+    };
+
+    /* 0. One repeated byte: no histogram, no table */
+    if (size > 0 && isRun(data, size)) {
+        uint64_t bits = writeRun(data[0], size, out);
+        if (bits) ++stats.blocks[BLOCK_RLE];   // 0: an earlier run grew
+        stats.payloadBits += bits;
+        stats.optimalBits += bits;
+        lap(stats.encodeNs);
+        return;
+    }
+    runAt_ = NO_RUN;
+
+    /* Huffman options also carry the payload size field(s) */
+    const uint64_t sizeFields = interleaved ? 4 * DecodeTable::STREAMS : 4;
+
+    /* 1. Price the options from the histogram; the entropy is a floor for
+     *    every code, so it can settle the choice before any tree is built */
+    Histogram hist = computeHistogram(data, size);
+    lap(stats.histogramNs);
+    double floorBits = entropyBits(hist, size);
+
+    uint64_t rawBytes   = size;
+    uint64_t reuseBits  = prevLengths_ ? bitsWith(hist, *prevLengths_) : UINT64_MAX;
+    uint64_t dictBits   = dict_ ? bitsWith(hist, dict_->lengths()) : UINT64_MAX;
+    uint64_t reuseBytes = payloadBytes(reuseBits, sizeFields);
+    uint64_t dictBytes  = payloadBytes(dictBits, sizeFields + 4);
+    uint64_t knownBytes = std::min({ rawBytes, reuseBytes, dictBytes });
+
+    unsigned count = 0;   // stored table length: highest used byte + 1
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s]) count = s + 1;
+    const uint64_t tableBytes = 2 + (count + 1) / 2;
+
+    uint64_t    newBits     = UINT64_MAX;
+    uint64_t    newBytes    = UINT64_MAX;
+    uint64_t    optimalBits = 0;
+    CodeLengths lengths{};
+    const bool  built = double(knownBytes) > floorBits / 8 + sizeFields + tableBytes;
+    if (built) {
+        lengths  = buildCodeLengths(hist, maxCodeLen_, &optimalBits);
+        newBits  = bitsWith(hist, lengths);
+        newBytes = payloadBytes(newBits, sizeFields + tableBytes);
+    }
+    lap(stats.treeNs);
+
+    /* 2. Write the cheapest */
+    uint8_t  type;
+    uint64_t bits;
+    if (rawBytes <= knownBytes && rawBytes <= newBytes) {
+        /* 2a. Stored */
+        type = BLOCK_RAW;
+        bits = uint64_t(size) * 8;
+        out.push_back(type);
+        putU32(out, static_cast<uint32_t>(size));
+        out.insert(out.end(), data, data + size);
+    } else if (reuseBytes <= dictBytes && reuseBytes <= newBytes) {
+        /* 2b. Previous code */
+        type = interleaved ? BLOCK_REUSE4 : BLOCK_REUSE;
+        bits = reuseBits;
+        out.push_back(type);
+        putU32(out, static_cast<uint32_t>(size));
+        writePayload(data, size, *prevTable_, bits, interleaved, out);
+    } else if (dictBytes <= newBytes) {
+        /* 2c. Dictionary code, which later blocks may reuse */
+        prevLengths_ = &dict_->lengths();
+        prevTable_   = &dict_->codes();
+
+        type = interleaved ? BLOCK_DICT4 : BLOCK_DICT;
+        bits = dictBits;
+        out.push_back(type);
+        putU32(out, static_cast<uint32_t>(size));
+        putU32(out, dict_->id());
+        writePayload(data, size, *prevTable_, bits, interleaved, out);
+    } else {
+        /* 2d. New code, which later blocks may reuse */
+        lengths_     = lengths;
+        table_       = canonicalCodes(lengths);
+        prevLengths_ = &lengths_;
+        prevTable_   = &table_;
+
+        type = interleaved ? BLOCK_HUFFMAN4 : BLOCK_HUFFMAN;
+        bits = newBits;
+        out.push_back(type);
+        putU32(out, static_cast<uint32_t>(size));
+        appendCodeLengths(out, lengths);
+        writePayload(data, size, table_, bits, interleaved, out);
+    }
+
+    ++stats.blocks[type];
+    stats.payloadBits += bits;
+    if (type == BLOCK_RAW) {
+        stats.optimalBits += bits;
+    } else {
+        stats.optimalBits += built ? optimalBits : bits;
+        stats.codedBytes  += size;
+        stats.codedBits   += bits;
+        stats.maxCodeLen   = std::max(stats.maxCodeLen, longestUsed(hist, *prevLengths_));
+    }
+    lap(stats.encodeNs);
+}
+
+void BlockEncoder::writePayload(const uint8_t* data, std::size_t size,
+                                const CodeTable& table, uint64_t bits,
+                                bool interleaved, std::vector<uint8_t>& out)
+{
+    const std::size_t payloadBytes = (bits + 7) / 8;
+
+    if (!interleaved) {
+        /* Payload size + payload packed in place */
+        putU32(out, static_cast<uint32_t>(payloadBytes));
+        std::size_t base = out.size();
+        out.resize(base + payloadBytes);
+        BitWriter writer(out.data() + base);
+        encodePacked(data, size, table, writer);
+        writer.finish();
+        return;
+    }
+
+    /* Four stream sizes, then one packed stream per segment.  Each stream
+     * pads to a byte, so 3 bytes over the single-stream size are always
+     * enough. */
+    const std::size_t sizes = out.size();
+    const std::size_t seg   = DecodeTable::segmentSize(size);
+    out.resize(sizes + 4 * DecodeTable::STREAMS + payloadBytes + DecodeTable::STREAMS - 1);
+
+    std::size_t pos = sizes + 4 * DecodeTable::STREAMS;
+    for (unsigned k = 0; k < DecodeTable::STREAMS; ++k) {
+        std::size_t start = std::min(k * seg, size);
+        BitWriter writer(out.data() + pos);
+        encodePacked(data + start, std::min(seg, size - start), table, writer);
+        uint32_t bytes = static_cast<uint32_t>(writer.finish());
+        for (int b = 0; b < 4; ++b)
+            out[sizes + 4 * k + b] = uint8_t(bytes >> (8 * b));
+        pos += bytes;
+    }
+    out.resize(pos);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Block decoder                                                     */
+/* ------------------------------------------------------------------ */
+
+bool BlockDecoder::decodePayload(const uint8_t* src, std::size_t srcSize,
+                                 std::size_t& in, const DecodeTable& table,
+                                 uint8_t* dst, std::size_t rawLen, bool interleaved)
+{
+    if (!interleaved) {
+        if (srcSize - in < 4) return false;
+        uint32_t payloadBytes = getU32(src + in);
+        in += 4;
+        if (srcSize - in < payloadBytes) return false;
+
+        if (rawLen > 0) {
+            BitReader reader(src + in, payloadBytes);
+            if (!table.decode(reader, dst, rawLen) ||
+                reader.bitsConsumed() > uint64_t(payloadBytes) * 8)
+                return false;
+        }
+        in += payloadBytes;
+        return true;
+    }
+
+    constexpr unsigned STREAMS = DecodeTable::STREAMS;
+    if (srcSize - in < 4 * STREAMS) return false;
+    const uint8_t* header = src + in;
+    uint32_t       streamBytes[STREAMS];
+    const uint8_t* stream[STREAMS];
+    in += 4 * STREAMS;
+    for (unsigned k = 0; k < STREAMS; ++k) {
+        streamBytes[k] = getU32(header + 4 * k);
+        if (srcSize - in < streamBytes[k]) return false;
+        stream[k] = src + in;
+        in += streamBytes[k];
+    }
+
+    BitReader readers[STREAMS] = {
+        BitReader(stream[0], streamBytes[0]), BitReader(stream[1], streamBytes[1]),
+        BitReader(stream[2], streamBytes[2]), BitReader(stream[3], streamBytes[3]) };
+
+    if (rawLen > 0) {
+        if (!table.decode4(readers, dst, rawLen)) return false;
+        for (unsigned k = 0; k < STREAMS; ++k)
+            if (readers[k].bitsConsumed() > uint64_t(streamBytes[k]) * 8)
+                return false;
+    }
+    return true;
+}
+
+bool BlockDecoder::decode(const uint8_t* src, std::size_t srcSize,
+                          uint8_t* dst, std::size_t rawSize)
+{
+    std::size_t in = 0, produced = 0;
+    const DecodeTable* current = nullptr;   // what REUSE blocks decode with
+
+    uint32_t   expected = 0, crc = 0;
+    const bool checked  = frameChecksum(src, srcSize, expected);
+    if (checked) in = CHECKSUM_BLOCK_SIZE;
+
+    while (produced < rawSize) {
+        if (srcSize - in < 5) return false;
+        uint8_t  type   = src[in];
+        uint32_t rawLen = getU32(src + in + 1);
+        in += 5;
+        if (rawLen > rawSize - produced) return false;
+
+        switch (type) {
+        case BLOCK_HUFFMAN:
+        case BLOCK_HUFFMAN4: {
+            CodeLengths lengths;
+            std::size_t used = parseCodeLengths(src + in, srcSize - in, lengths);
+            if (!used) return false;
+            in += used;
+
+            if (rawLen > 0) {
+                /* a long block (or the REUSE blocks after it) amortizes the
+                   multi-symbol table; a short one decodes sooner without */
+                if (!table_.build(canonicalCodes(lengths),
+                                  rawLen >= DecodeTable::MULTI_MIN_SYMBOLS))
+                    return false;
+                current = &table_;
+            }
+            if (!decodePayload(src, srcSize, in, table_, dst + produced, rawLen,
+                               type == BLOCK_HUFFMAN4))
+                return false;
+            break;
+        }
+        case BLOCK_REUSE:
+        case BLOCK_REUSE4:
+            if (!current ||
+                !decodePayload(src, srcSize, in, *current, dst + produced, rawLen,
+                               type == BLOCK_REUSE4))
+                return false;
+            break;
+        case BLOCK_DICT:
+        case BLOCK_DICT4:
+            /* the table must be the one the writer trained, not just any */
+            if (!dict_ || srcSize - in < 4 || getU32(src + in) != dict_->id())
+                return false;
+            in += 4;
+            current = &dict_->decodeTable();
+            if (!decodePayload(src, srcSize, in, *current, dst + produced, rawLen,
+                               type == BLOCK_DICT4))
+                return false;
+            break;
+        case BLOCK_RAW:
+            if (srcSize - in < rawLen) return false;
+            std::memcpy(dst + produced, src + in, rawLen);
+            in += rawLen;
+            break;
+        case BLOCK_RLE:
+            if (srcSize - in < 1) return false;
+            std::memset(dst + produced, src[in], rawLen);
+            in += 1;
+            break;
+        default:
+            return false;
+        }
+        if (checked) crc = crc32c(crc, dst + produced, rawLen);   // still in cache
+        produced += rawLen;
+    }
+    return in == srcSize && (!checked || crc == expected);
+}
@@ -0,0 +1,163 @@
+#include "Checksum.h"
+
+#include <cstring>           // std::memcpy
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>       // _mm_crc32_u64, _mm_crc32_u8
+#endif
+
+using namespace huffman;
+
+/** @brief CRC-32C polynomial, bit-reflected. */
+static constexpr uint32_t POLY = 0x82F63B78;
+
+/** @brief Bytes per lane of the three-lane hardware loop. */
+static constexpr std::size_t LANE = 8192;
+
+/**
+ * @brief a(x) · b(x) mod P(x), both reflected (bit 31 = x^0).
+ *
+ * The CRC register is linear, so multiplying it by x^(8n) mod P is the
+ * same as running it over n zero bytes.
+ */
+static uint32_t multModP(uint32_t a, uint32_t b)
+{
+    uint32_t product = 0;
+    for (uint32_t m = uint32_t(1) << 31; m; m >>= 1) {
+        if (a & m) product ^= b;
+        b = b & 1 ? (b >> 1) ^ POLY : b >> 1;
+    }
+    return product;
+}
+
+namespace {
+
+/** @brief Lookup tables, built once on first use. */
+struct Tables {
+    uint32_t slice[8][256];      ///< slicing-by-8 (software path)
+    uint32_t x2n[32];            ///< x^(2^k) mod P
+    uint32_t shiftLane[4][256];  ///< register × x^(8·LANE), one table per byte
+
+    Tables()
+    {
+        for (uint32_t n = 0; n < 256; ++n) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; ++k) c = c & 1 ? (c >> 1) ^ POLY : c >> 1;
+            slice[0][n] = c;
+        }
+        for (uint32_t n = 0; n < 256; ++n)
+            for (int k = 1; k < 8; ++k)
+                slice[k][n] = (slice[k - 1][n] >> 8) ^ slice[0][slice[k - 1][n] & 0xFF];
+
+        x2n[0] = uint32_t(1) << 30;   // x^1
+        for (int k = 1; k < 32; ++k) x2n[k] = multModP(x2n[k - 1], x2n[k - 1]);
+
+        const uint32_t lane = xPow8n(LANE);
+        for (int k = 0; k < 4; ++k)
+            for (uint32_t n = 0; n < 256; ++n)
+                shiftLane[k][n] = multModP(lane, n << (8 * k));
+    }
+
+    /** @brief x^(8·n) mod P: the factor that appends n zero bytes. */
+    uint32_t xPow8n(uint64_t n) const
+    {
+        uint32_t p = uint32_t(1) << 31;   // x^0
+        for (unsigned k = 3; n; n >>= 1, ++k)
+            if (n & 1) p = multModP(x2n[k & 31], p);
+        return p;
+    }
+
+    /** @brief Register `crc` followed by LANE zero bytes. */
+    uint32_t shift(uint32_t crc) const
+    {
+        return shiftLane[0][crc & 0xFF] ^ shiftLane[1][(crc >> 8) & 0xFF] ^
+               shiftLane[2][(crc >> 16) & 0xFF] ^ shiftLane[3][crc >> 24];
+    }
+};
+
+}  // namespace
+
+static const Tables& tables()
+{
+    static const Tables t;
+    return t;
+}
+
+/** @brief Slicing-by-8 over the raw (pre-inverted) register; little-endian host. */
+static uint32_t crcSoftware(uint32_t crc, const uint8_t* p, std::size_t n)
+{
+    const auto& T = tables().slice;
+    for (; n >= 8; p += 8, n -= 8) {
+        uint64_t v;
+        std::memcpy(&v, p, 8);
+        v ^= crc;
+        crc = T[7][v & 0xFF]         ^ T[6][(v >> 8) & 0xFF]  ^
+              T[5][(v >> 16) & 0xFF] ^ T[4][(v >> 24) & 0xFF] ^
+              T[3][(v >> 32) & 0xFF] ^ T[2][(v >> 40) & 0xFF] ^
+              T[1][(v >> 48) & 0xFF] ^ T[0][v >> 56];
+    }
+    for (; n; ++p, --n) crc = (crc >> 8) ^ T[0][(crc ^ *p) & 0xFF];
+    return crc;
+}
+
+#if defined(__x86_64__)
+/**
+ * @brief SSE4.2 path.  The instruction has a latency of three cycles but a
+ *        throughput of one, so long buffers run three independent lanes and
+ *        join them with the zero-byte shift.
+ */
+__attribute__((target("sse4.2")))
+static uint32_t crcHardware(uint32_t crc, const uint8_t* p, std::size_t n)
+{
+    auto load = [](const uint8_t* q) {
+        uint64_t v;
+        std::memcpy(&v, q, 8);
+        return v;
+    };
+
+    if (n >= 3 * LANE) {
+        const Tables& t = tables();
+        do {
+            uint64_t c0 = crc, c1 = 0, c2 = 0;
+            for (std::size_t i = 0; i < LANE; i += 8) {
+                c0 = _mm_crc32_u64(c0, load(p + i));
+                c1 = _mm_crc32_u64(c1, load(p + LANE + i));
+                c2 = _mm_crc32_u64(c2, load(p + 2 * LANE + i));
+            }
+            crc = t.shift(t.shift(uint32_t(c0)) ^ uint32_t(c1)) ^ uint32_t(c2);
+            p += 3 * LANE;
+            n -= 3 * LANE;
+        } while (n >= 3 * LANE);
+    }
+
+    uint64_t c = crc;
+    for (; n >= 8; p += 8, n -= 8) c = _mm_crc32_u64(c, load(p));
+    crc = uint32_t(c);
+    for (; n; ++p, --n) crc = _mm_crc32_u8(crc, *p);
+    return crc;
+}
+#endif
+
+bool huffman::crc32cHardware()
+{
+#if defined(__x86_64__)
+    static const bool sse42 = __builtin_cpu_supports("sse4.2");
+    return sse42;
+#else
+    return false;
+#endif
+}
+
+uint32_t huffman::crc32c(uint32_t crc, const void* data, std::size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+#if defined(__x86_64__)
+    if (crc32cHardware()) return ~crcHardware(~crc, p, size);
+#endif
+    return ~crcSoftware(~crc, p, size);
+}
+
+uint32_t huffman::crc32cCombine(uint32_t crcA, uint32_t crcB, uint64_t sizeB)
+{
+    return multModP(tables().xPow8n(sizeB), crcA) ^ crcB;
+}
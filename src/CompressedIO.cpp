@@ -1,127 +1,1067 @@
 #include "CompressedIO.h"
-#include "HuffmanUtils.h"    // readFileToString() and deleteTree()
 #include "frequency.h"
 #include "HuffmanTree.h"
 #include "HuffmanCodes.h"
 #include "HuffmanEncoder.h"
 #include "HuffmanDecoder.h"
+#include "BlockCodec.h"
+#include "Checksum.h"
+#include "ThreadPool.h"
+#include "FileIO.h"          // MappedFile, ReadAhead, FileWriter, AsyncWriter, ByteSink
 
 #include <fstream>
+#include <istream>
+#include <iterator>
+#include <ostream>
 #include <cstdint>
 #include <vector>
-#include <unordered_map>
+#include <utility>
+#include <algorithm>
+#include <chrono>
 #include <cstring>           // std::memcmp
+#include <deque>
+#include <future>
+#include <memory>
 
 using namespace huffman;
 using namespace huffman::util;
 
-static constexpr char MAGIC[4] = { 'H','U','F','0' };
+/* ------------------------------------------------------------------ */
+/*  Byte sources and sinks                                            */
+/* ------------------------------------------------------------------ */
 
-bool util::writeCompressedFile(const std::string& inputPath,
-                               const std::string& compressedPath)
-{
-    /* 1. Read whole input (binary) */
-    std::string data = readFileToString(inputPath);
-
-    /* 2. Build Huffman */
-    auto freqMap  = computeFrequencies(data);
-    HuffmanNode* root = buildHuffmanTree(freqMap);
-    auto  codes   = generateHuffmanCodes(root);
-    std::string bitstr = encodeText(data, codes);
-
-    /* 3. Pack bits -> bytes (MSB-first) */
-    uint64_t bitCount = bitstr.size();
-    size_t   byteCount = (bitCount + 7) / 8;
-    std::vector<uint8_t> buffer(byteCount, 0);
-    for (uint64_t i = 0; i < bitCount; ++i)
-        if (bitstr[i] == '1')
-            buffer[i / 8] |= uint8_t(1 << (7 - (i % 8)));
-
-    /* 4. Write header + table + payload */
-    std::ofstream out(compressedPath, std::ios::binary);
-    if (!out) { deleteTree(root); return false; }
-
-    /* 4.1 magic */
-    out.write(MAGIC, 4);
-
-    /* 4.2 unique-symbol count */
-    uint32_t uniq = static_cast<uint32_t>(freqMap.size());
-    out.write(reinterpret_cast<char*>(&uniq), sizeof(uniq));
-
-    /* 4.3 symbol table */
-    for (auto const& [ch, freq] : freqMap) {
-        out.put(ch);
+/** @brief A run of input bytes: a view into a mapping, or owned storage. */
+struct Chunk {
+    std::vector<uint8_t> owned;
+    const uint8_t*       data = nullptr;
+    std::size_t          size = 0;
+};
+
+/** @brief Sequential input from an istream (pipes, small files); chunks are copies. */
+class StreamSource {
+public:
+    explicit StreamSource(std::istream& in) : in_(in) {}
+
+    /** @brief Copy exactly `n` bytes into `dst`. */
+    bool read(void* dst, std::size_t n)
+    {
+        in_.read(static_cast<char*>(dst), static_cast<std::streamsize>(n));
+        return static_cast<std::size_t>(in_.gcount()) == n;
+    }
+
+    /** @brief Up to `max` bytes into `chunk`; returns how many (0 at the end). */
+    std::size_t take(std::size_t max, Chunk& chunk)
+    {
+        chunk.owned.resize(max);
+        in_.read(reinterpret_cast<char*>(chunk.owned.data()),
+                 static_cast<std::streamsize>(max));
+        chunk.owned.resize(static_cast<std::size_t>(in_.gcount()));
+        chunk.data = chunk.owned.data();
+        chunk.size = chunk.owned.size();
+        return chunk.size;
+    }
+
+    /** @brief Everything left in the input. */
+    void rest(Chunk& chunk)
+    {
+        chunk.owned.assign(std::istreambuf_iterator<char>(in_),
+                           std::istreambuf_iterator<char>());
+        chunk.data = chunk.owned.data();
+        chunk.size = chunk.owned.size();
+    }
+
+    bool bad() const { return in_.bad(); }
+
+private:
+    std::istream& in_;
+};
+
+/** @brief Same interface over an in-memory (mapped) input; chunks are views. */
+class SpanSource {
+public:
+    SpanSource(const uint8_t* data, std::size_t size) : p_(data), left_(size) {}
+
+    bool read(void* dst, std::size_t n)
+    {
+        if (n > left_) { left_ = 0; return false; }
+        std::memcpy(dst, p_, n);
+        p_ += n;  left_ -= n;
+        return true;
+    }
+
+    std::size_t take(std::size_t max, Chunk& chunk)
+    {
+        std::size_t n = std::min(max, left_);
+        chunk.owned.clear();
+        chunk.data = p_;
+        chunk.size = n;
+        p_ += n;  left_ -= n;
+        return n;
+    }
+
+    void rest(Chunk& chunk) { take(left_, chunk); }
+
+    bool bad() const { return false; }
+
+private:
+    const uint8_t* p_;
+    std::size_t    left_;
+};
+
+/**
+ * @brief Same interface over a ReadAhead: segments come from the reader thread.
+ *
+ * A take() that matches a whole segment hands that buffer over; anything
+ * else is copied across segment boundaries.
+ */
+class PipelineSource {
+public:
+    explicit PipelineSource(ReadAhead& in) : in_(in) {}
+
+    bool read(void* dst, std::size_t n)
+    {
+        return copy(static_cast<uint8_t*>(dst), n) == n;
+    }
+
+    std::size_t take(std::size_t max, Chunk& chunk)
+    {
+        if (pos_ == segment_.size()) refill();
+        if (pos_ == 0 && segment_.size() == max) {
+            chunk.owned.swap(segment_);
+            segment_.clear();   // its old buffer goes back to the reader
+        } else {
+            chunk.owned.resize(max);
+            chunk.owned.resize(copy(chunk.owned.data(), max));
+        }
+        chunk.data = chunk.owned.data();
+        chunk.size = chunk.owned.size();
+        return chunk.size;
+    }
+
+    void rest(Chunk& chunk)
+    {
+        chunk.owned.assign(segment_.begin() + pos_, segment_.end());
+        pos_ = segment_.size();
+        while (refill()) {
+            chunk.owned.insert(chunk.owned.end(), segment_.begin(), segment_.end());
+            pos_ = segment_.size();
+        }
+        chunk.data = chunk.owned.data();
+        chunk.size = chunk.owned.size();
+    }
+
+    bool bad() const { return in_.failed(); }
+
+private:
+    bool refill()
+    {
+        if (!in_.next(segment_)) return false;
+        pos_ = 0;
+        return true;
+    }
+
+    /** @brief Copy up to `n` bytes; fewer only at the end of the input. */
+    std::size_t copy(uint8_t* dst, std::size_t n)
+    {
+        std::size_t got = 0;
+        while (got < n) {
+            if (pos_ == segment_.size() && !refill()) break;
+            std::size_t k = std::min(n - got, segment_.size() - pos_);
+            std::memcpy(dst + got, segment_.data() + pos_, k);
+            got  += k;
+            pos_ += k;
+        }
+        return got;
+    }
+
+    ReadAhead&           in_;
+    std::vector<uint8_t> segment_;
+    std::size_t          pos_ = 0;
+};
+
+/** @brief ByteSink adapter for std::ostream (stdout, caller-owned streams). */
+class StreamSink : public ByteSink {
+public:
+    explicit StreamSink(std::ostream& out) : out_(out) {}
+
+    bool write(const void* data, std::size_t size) override
+    {
+        out_.write(static_cast<const char*>(data), static_cast<std::streamsize>(size));
+        return static_cast<bool>(out_);
+    }
+
+    bool flush() override
+    {
+        out_.flush();
+        return static_cast<bool>(out_);
+    }
+
+private:
+    std::ostream& out_;
+};
+
+/**
+ * @brief Whether a file of `size` bytes should go through the pipeline.
+ *
+ * The reader and writer threads only pay off when they get a core of
+ * their own; on a single core the handoffs cost more than the overlap.
+ */
+static bool usePipeline(uint64_t size)
+{
+    static const bool cores = ThreadPool::resolve(0) > 1;
+    return cores && size >= PIPELINE_THRESHOLD;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Instrumentation                                                   */
+/* ------------------------------------------------------------------ */
+
+static uint64_t nowNs()
+{
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** @brief Charges elapsed time to Stats stages; a no-op without Stats. */
+class StageTimer {
+public:
+    explicit StageTimer(Stats* stats) : stats_(stats), mark_(stats ? nowNs() : 0) {}
+
+    /** @brief Charge the time since construction or the last lap to `stage`. */
+    void lap(Stats::Stage stage)
+    {
+        if (!stats_) return;
+        uint64_t now = nowNs();
+        stats_->stageNs[stage] += now - mark_;
+        mark_ = now;
+    }
+
+private:
+    Stats*   stats_;
+    uint64_t mark_;
+};
+
+/** @brief Source wrapper that counts input bytes and charges reads to READ. */
+template <typename Source>
+class MeteredSource {
+public:
+    MeteredSource(Source& in, Stats* stats) : in_(in), stats_(stats) {}
+
+    bool read(void* dst, std::size_t n)
+    {
+        StageTimer timer(stats_);
+        bool ok = in_.read(dst, n);
+        timer.lap(Stats::READ);
+        if (stats_ && ok) stats_->inputBytes += n;
+        return ok;
+    }
+
+    std::size_t take(std::size_t max, Chunk& chunk)
+    {
+        StageTimer timer(stats_);
+        std::size_t n = in_.take(max, chunk);
+        timer.lap(Stats::READ);
+        if (stats_) stats_->inputBytes += n;
+        return n;
+    }
+
+    void rest(Chunk& chunk)
+    {
+        StageTimer timer(stats_);
+        in_.rest(chunk);
+        timer.lap(Stats::READ);
+        if (stats_) stats_->inputBytes += chunk.size;
+    }
+
+    bool bad() const { return in_.bad(); }
+
+private:
+    Source& in_;
+    Stats*  stats_;
+};
+
+/** @brief ByteSink decorator that counts output bytes and charges writes to WRITE. */
+class MeteredSink : public ByteSink {
+public:
+    MeteredSink(ByteSink& out, Stats* stats) : out_(out), stats_(stats) {}
+
+    bool write(const void* data, std::size_t size) override
+    {
+        StageTimer timer(stats_);
+        bool ok = out_.write(data, size);
+        timer.lap(Stats::WRITE);
+        if (stats_ && ok) stats_->outputBytes += size;
+        return ok;
+    }
+
+    bool flush() override
+    {
+        StageTimer timer(stats_);
+        bool ok = out_.flush();
+        timer.lap(Stats::WRITE);
+        return ok;
+    }
+
+    void preallocate(uint64_t bytes) override { out_.preallocate(bytes); }
+
+private:
+    ByteSink& out_;
+    Stats*    stats_;
+};
+
+Stats& Stats::operator+=(const BlockStats& encoded)
+{
+    codedSymbols += encoded.codedBytes;
+    codedBits    += encoded.codedBits;
+    payloadBits  += encoded.payloadBits;
+    optimalBits  += encoded.optimalBits;
+    maxCodeLen    = std::max(maxCodeLen, encoded.maxCodeLen);
+    for (unsigned t = 0; t < BLOCK_TYPES; ++t) blocks[t] += encoded.blocks[t];
+    stageNs[HISTOGRAM] += encoded.histogramNs;
+    stageNs[TREE]      += encoded.treeNs;
+    stageNs[ENCODE]    += encoded.encodeNs;
+    return *this;
+}
+
+/** @brief Longest code among the bytes present in `hist`. */
+static unsigned longestCode(const Histogram& hist, const CodeTable& table)
+{
+    unsigned longest = 0;
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s]) longest = std::max<unsigned>(longest, table[s].len);
+    return longest;
+}
+
+/** @brief Symbol and bit counters of a whole-buffer (HUF0/HUF1) payload. */
+static void countPayload(Stats& stats, const Histogram& hist, const CodeTable& table,
+                         std::size_t size, uint64_t bitCount, uint64_t optimalBits)
+{
+    stats.codedSymbols = size;
+    stats.codedBits    = bitCount;
+    stats.payloadBits  = bitCount;
+    stats.optimalBits  = optimalBits;
+    stats.maxCodeLen   = longestCode(hist, table);
+}
+
+/* ------------------------------------------------------------------ */
+/*  Writers                                                           */
+/* ------------------------------------------------------------------ */
+
+/** @brief Encode `data` with `table` into a freshly sized packed buffer. */
+static std::vector<uint8_t> packPayload(const uint8_t* data, std::size_t size,
+                                        const Histogram& hist,
+                                        const CodeTable& table,
+                                        uint64_t& bitCount)
+{
+    bitCount = encodedBitCount(hist, table);
+    std::vector<uint8_t> buffer((bitCount + 7) / 8);
+    BitWriter writer(buffer.data());
+    encodePacked(data, size, table, writer);
+    writer.finish();
+    return buffer;
+}
+
+/** @brief HUF0: char + uint32 frequency per symbol, tree rebuilt on read. */
+static bool writeHUF0(ByteSink& out, const uint8_t* data, std::size_t size,
+                      const CompressOptions& options)
+{
+    StageTimer timer(options.stats);
+    Histogram hist = computeHistogram(data, size,
+                                      ThreadPool::resolve(options.threads));
+    timer.lap(Stats::HISTOGRAM);
+
+    /* Fix one table order: the tree and the header must agree on it */
+    std::vector<std::pair<char,uint64_t>> leaves;
+    for (unsigned s = 0; s < hist.size(); ++s) {
+        if (!hist[s]) continue;
+        if (hist[s] > UINT32_MAX) return false;   // HUF0 stores uint32 counts
+        leaves.emplace_back(static_cast<char>(s), hist[s]);
+    }
+    HuffmanTree tree;
+    buildHuffmanTree(leaves, tree);
+    CodeTable table = generateHuffmanCodes(tree);
+    if (leaves.size() == 1) table = CodeTable{};   // one symbol: HUF0 stores no bits
+    timer.lap(Stats::TREE);
+
+    uint64_t bitCount;
+    std::vector<uint8_t> buffer = packPayload(data, size, hist, table, bitCount);
+    timer.lap(Stats::ENCODE);
+
+    /* unbounded Huffman: the payload is already the optimum */
+    if (options.stats)
+        countPayload(*options.stats, hist, table, size, bitCount, bitCount);
+
+    uint32_t uniq = static_cast<uint32_t>(leaves.size());
+    bool ok = out.write(MAGIC_HUF0, 4) && out.write(&uniq, sizeof(uniq));
+
+    for (auto const& [ch, freq] : leaves) {
         uint32_t f = static_cast<uint32_t>(freq);
-        out.write(reinterpret_cast<char*>(&f), sizeof(f));
+        ok = ok && out.write(&ch, 1) && out.write(&f, sizeof(f));
     }
 
-    /* 4.4 total bit-count */
-    out.write(reinterpret_cast<char*>(&bitCount), sizeof(bitCount));
+    return ok && out.write(&bitCount, sizeof(bitCount))
+              && out.write(buffer.data(), buffer.size());
+}
+
+/** @brief HUF1: canonical codes, header holds only 4-bit code lengths. */
+static bool writeHUF1(ByteSink& out, const uint8_t* data, std::size_t size,
+                      const CompressOptions& options)
+{
+    StageTimer timer(options.stats);
+    Histogram hist = computeHistogram(data, size,
+                                      ThreadPool::resolve(options.threads));
+    timer.lap(Stats::HISTOGRAM);
+
+    uint64_t optimalBits;
+    unsigned maxLen = std::clamp(options.maxCodeLen, 1u, MAX_STORED_CODE_LEN);
+    CodeLengths lengths = buildCodeLengths(hist, maxLen, &optimalBits);
+    CodeTable   table   = canonicalCodes(lengths);
+    timer.lap(Stats::TREE);
+
+    uint64_t bitCount;
+    std::vector<uint8_t> buffer = packPayload(data, size, hist, table, bitCount);
+    timer.lap(Stats::ENCODE);
+
+    if (options.stats)
+        countPayload(*options.stats, hist, table, size, bitCount, optimalBits);
 
-    /* 4.5 payload */
-    out.write(reinterpret_cast<char*>(buffer.data()),
-              static_cast<std::streamsize>(buffer.size()));
+    std::vector<uint8_t> header;
+    appendCodeLengths(header, lengths);
 
-    deleteTree(root);
-    return static_cast<bool>(out);
+    uint64_t symbols = size;
+
+    return out.write(MAGIC_HUF1, 4)
+        && out.write(&symbols, sizeof(symbols))
+        && out.write(header.data(), header.size())
+        && out.write(&bitCount, sizeof(bitCount))
+        && out.write(buffer.data(), buffer.size());
 }
 
-bool util::readCompressedFile(const std::string& compressedPath,
-                              const std::string& outputPath)
+/** @brief One HUF2 frame: raw size + encoded (or decoded) bytes. */
+struct Frame {
+    uint32_t             rawSize = 0;
+    std::vector<uint8_t> bytes;
+    bool                 ok = true;
+    BlockStats           stats;         ///< encoder side only
+    uint64_t             decodeNs = 0;  ///< decoder side only, when timed
+};
+
+/** @brief Encode one block; each worker keeps its own encoder scratch. */
+static Frame encodeFrame(const Chunk& raw, const CompressOptions& options)
 {
-    std::ifstream in(compressedPath, std::ios::binary);
-    if (!in) return false;
+    thread_local BlockEncoder encoder;
+    encoder.setMaxCodeLen(options.maxCodeLen);
+    encoder.setStreams(options.streams);
+    encoder.setSubBlockSize(options.subBlockSize);
+    encoder.setDictionary(options.dictionary);
+    encoder.setTiming(options.stats != nullptr);
+    encoder.setChecksum(options.checksum);
 
-    /* 1. verify magic */
-    char magic[4];
-    in.read(magic, 4);
-    if (in.gcount() != 4 || std::memcmp(magic, MAGIC, 4) != 0)
+    Frame frame;
+    frame.rawSize = static_cast<uint32_t>(raw.size);
+    frame.stats   = encoder.encode(raw.data, raw.size, frame.bytes);
+    return frame;
+}
+
+static bool writeFrame(ByteSink& out, const Frame& frame)
+{
+    uint32_t sizes[2] = { frame.rawSize, static_cast<uint32_t>(frame.bytes.size()) };
+    return out.write(sizes, sizeof(sizes))
+        && out.write(frame.bytes.data(), frame.bytes.size());
+}
+
+/**
+ * @brief HUF2: one self-describing frame per block, then an end marker.
+ *
+ * With more than one thread, blocks are encoded on a pool and written back
+ * in input order through a bounded window of futures (2 per worker), which
+ * caps memory at roughly 2 × threads × blockSize.  Blocks taken from a
+ * mapped input are views, so only the encoded frames are allocated.
+ */
+template <typename Source>
+static bool writeHUF2(Source& in, ByteSink& out, const CompressOptions& options)
+{
+    const std::size_t blockSize = options.blockSize;
+    const unsigned    threads   = ThreadPool::resolve(options.threads);
+    Stats* const      stats     = options.stats;
+
+    /* Frame index for seekable files: where each frame header starts */
+    std::vector<uint64_t> index;
+    uint64_t position = 8, rawTotal = 0;
+    uint32_t fileCrc  = 0;   // chained from the frame checksums, in order
+
+    auto emit = [&](const Frame& frame) {
+        if (options.seekable) index.push_back(position);
+        position += 8 + frame.bytes.size();
+        rawTotal += frame.rawSize;
+        uint32_t crc;
+        if (frameChecksum(frame.bytes.data(), frame.bytes.size(), crc))
+            fileCrc = crc32cCombine(fileCrc, crc, frame.rawSize);
+        if (stats) {
+            *stats += frame.stats;
+            ++stats->frames;
+            stats->peakFrameBytes = std::max<uint64_t>(stats->peakFrameBytes,
+                                                       frame.bytes.size());
+        }
+        return writeFrame(out, frame);
+    };
+
+    uint32_t bs = static_cast<uint32_t>(blockSize);
+    bool ok = out.write(MAGIC_HUF2, 4) && out.write(&bs, sizeof(bs));
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1) pool = std::make_unique<ThreadPool>(threads);
+    const std::size_t window = pool ? 2 * std::size_t(pool->size()) : 0;
+    std::deque<std::future<Frame>> pending;
+
+    Chunk raw;
+    while (ok && in.take(blockSize, raw) > 0) {
+        if (!pool) {
+            if (stats) stats->peakFramesInFlight = 1;
+            ok = emit(encodeFrame(raw, options));
+            continue;
+        }
+        if (pending.size() == window) {
+            ok = emit(pending.front().get());
+            pending.pop_front();
+        }
+        pending.push_back(pool->submit([block = std::move(raw), &options] {
+            return encodeFrame(block, options);
+        }));
+        if (stats)
+            stats->peakFramesInFlight = std::max<uint64_t>(stats->peakFramesInFlight,
+                                                           pending.size());
+        raw = Chunk();
+    }
+    while (!pending.empty()) {
+        ok = ok && emit(pending.front().get());
+        pending.pop_front();
+    }
+    if (!ok || in.bad()) return false;
+
+    /* end marker: rawSize = frameSize = 0 */
+    uint32_t zero[2] = { 0, 0 };
+    if (!out.write(zero, sizeof(zero))) return false;
+
+    if (options.checksum &&
+        !(out.write(MAGIC_CHECKSUM, 4) && out.write(&fileCrc, sizeof(fileCrc))))
         return false;
 
-    /* 2. unique count */
-    uint32_t uniq;
-    in.read(reinterpret_cast<char*>(&uniq), sizeof(uniq));
-    if (!in) return false;
+    if (options.seekable) {
+        uint32_t frames = static_cast<uint32_t>(index.size());
+        ok = out.write(index.data(), index.size() * sizeof(uint64_t))
+          && out.write(&rawTotal, sizeof(rawTotal))
+          && out.write(&frames, sizeof(frames))
+          && out.write(MAGIC_INDEX, 4);
+    }
+    return ok && out.flush();
+}
 
-    /* 3. frequency table */
-    std::unordered_map<char,int> freqMap;
-    for (uint32_t i = 0; i < uniq; ++i) {
-        char ch = in.get();
-        uint32_t f;
-        in.read(reinterpret_cast<char*>(&f), sizeof(f));
+template <typename Source>
+static bool compressBody(Source& in, ByteSink& out, const CompressOptions& options)
+{
+    if (options.format == Format::HUF2) {
+        if (options.blockSize == 0 || options.blockSize > MAX_BLOCK_SIZE)
+            return false;
+        return writeHUF2(in, out, options);
+    }
+
+    /* Legacy whole-buffer formats */
+    Chunk data;
+    in.rest(data);
+    if (in.bad()) return false;
+    bool ok = options.format == Format::HUF0
+            ? writeHUF0(out, data.data, data.size, options)
+            : writeHUF1(out, data.data, data.size, options);
+    return out.flush() && ok;
+}
+
+template <typename Source>
+static bool compressFrom(Source& in, ByteSink& out, const CompressOptions& options)
+{
+    if (options.stats) *options.stats = Stats();
+    const uint64_t start = options.stats ? nowNs() : 0;
+
+    MeteredSource<Source> source(in, options.stats);
+    MeteredSink           sink(out, options.stats);
+    bool ok = compressBody(source, sink, options);
+
+    if (options.stats) options.stats->totalNs = nowNs() - start;
+    return ok;
+}
+
+bool util::compressStream(std::istream& in, std::ostream& out,
+                          const CompressOptions& options)
+{
+    StreamSource source(in);
+    StreamSink   sink(out);
+    return compressFrom(source, sink, options);
+}
+
+bool util::writeCompressedFile(const std::string& inputPath,
+                               const std::string& compressedPath,
+                               const CompressOptions& options)
+{
+    /* Large HUF2 jobs run as a pipeline: reader thread → encoder → writer
+     * thread, each stage working on a different block */
+    ReadAhead ahead;
+    if (options.format == Format::HUF2 && ahead.open(inputPath) &&
+        usePipeline(ahead.size())) {
+        FileWriter out;
+        if (!out.open(compressedPath)) return false;
+        bool ok;
+        {
+            AsyncWriter writer(out);
+            bool blockOk = options.blockSize > 0 && options.blockSize <= MAX_BLOCK_SIZE;
+            ahead.start(blockOk ? options.blockSize : WRITE_BUFFER_SIZE);
+            PipelineSource source(ahead);
+            ok = compressFrom(source, writer, options);
+        }
+        return out.close() && ok;
+    }
+
+    /* Other large regular files are mapped; small ones keep the iostream path */
+    MappedFile    mapped;
+    std::ifstream in;
+    if (!mapped.open(inputPath)) {
+        in.open(inputPath, std::ios::binary);
         if (!in) return false;
-        freqMap[ch] = static_cast<int>(f);
     }
 
-    /* 4. bit-count */
+    FileWriter out;
+    if (!out.open(compressedPath)) return false;
+
+    bool ok;
+    if (mapped.data()) {
+        SpanSource source(mapped.data(), mapped.size());
+        ok = compressFrom(source, out, options);
+    } else {
+        StreamSource source(in);
+        ok = compressFrom(source, out, options);
+    }
+    return out.close() && ok;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Readers                                                           */
+/* ------------------------------------------------------------------ */
+
+/** @brief Read bit-count + payload and decode `total` symbols with `codes`. */
+template <typename Source>
+static bool decodePayload(Source& in, const CodeTable& codes,
+                          uint64_t total, std::string& decoded, Stats* stats)
+{
     uint64_t bitCount;
-    in.read(reinterpret_cast<char*>(&bitCount), sizeof(bitCount));
-    if (!in) return false;
+    if (!in.read(&bitCount, sizeof(bitCount))) return false;
 
-    /* 5. payload bytes */
     size_t byteCount = (bitCount + 7) / 8;
-    std::vector<uint8_t> buffer(byteCount);
-    in.read(reinterpret_cast<char*>(buffer.data()),
-            static_cast<std::streamsize>(byteCount));
+    Chunk payload;
+    if (in.take(byteCount, payload) != byteCount) return false;
+
+    StageTimer timer(stats);
+    decoded.assign(total, '\0');
+    if (total == 0) return true;
+
+    DecodeTable table;
+    if (!table.build(codes, total >= DecodeTable::MULTI_MIN_SYMBOLS)) return false;
+
+    BitReader reader(payload.data, payload.size);
+    bool ok = table.decode(reader, reinterpret_cast<uint8_t*>(&decoded[0]), total)
+           && reader.bitsConsumed() <= bitCount;
+    timer.lap(Stats::DECODE);
+    return ok;
+}
+
+/** @brief HUF0 body (after the magic): frequency table + payload. */
+template <typename Source>
+static bool readHUF0(Source& in, std::string& decoded, Stats* stats)
+{
+    uint32_t uniq;
+    if (!in.read(&uniq, sizeof(uniq)) || uniq > 256) return false;
+
+    /* Keep the on-disk order: the writer built its tree in this order */
+    std::vector<std::pair<char,uint64_t>> leaves;
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < uniq; ++i) {
+        char ch;
+        uint32_t f;
+        if (!in.read(&ch, 1) || !in.read(&f, sizeof(f))) return false;
+        leaves.emplace_back(ch, f);
+        total += f;
+    }
+
+    if (uniq == 1) {
+        /* a single-leaf tree has an empty code: the payload carries no bits */
+        uint64_t bitCount;
+        if (!in.read(&bitCount, sizeof(bitCount))) return false;
+        decoded.assign(total, leaves[0].first);
+        return true;
+    }
+
+    CodeTable codes{};
+    if (!leaves.empty()) {
+        HuffmanTree tree;
+        buildHuffmanTree(leaves, tree);
+        codes = generateHuffmanCodes(tree);
+    }
+    return decodePayload(in, codes, total, decoded, stats);
+}
+
+/** @brief HUF1 body (after the magic): code lengths + payload, no tree. */
+template <typename Source>
+static bool readHUF1(Source& in, std::string& decoded, Stats* stats)
+{
+    uint64_t symbols;
+    uint8_t  countBytes[2];
+    if (!in.read(&symbols, sizeof(symbols)) ||
+        !in.read(countBytes, sizeof(countBytes)))
+        return false;
+
+    unsigned lenCount = unsigned(countBytes[0]) | unsigned(countBytes[1]) << 8;
+    if (lenCount > 256) return false;
+
+    std::vector<uint8_t> table(2 + (lenCount + 1) / 2);
+    table[0] = countBytes[0];
+    table[1] = countBytes[1];
+    if (!in.read(table.data() + 2, table.size() - 2)) return false;
+
+    CodeLengths lengths;
+    if (!parseCodeLengths(table.data(), table.size(), lengths)) return false;
+
+    return decodePayload(in, canonicalCodes(lengths), symbols, decoded, stats);
+}
+
+/** @brief Decode one frame body into its raw bytes; `timed` fills decodeNs. */
+static Frame decodeFrame(const Chunk& body, uint32_t rawSize,
+                         const Dictionary* dictionary, bool timed)
+{
+    thread_local BlockDecoder decoder;
+    decoder.setDictionary(dictionary);
+    const uint64_t start = timed ? nowNs() : 0;
+    Frame raw;
+    raw.rawSize = rawSize;
+    raw.bytes.resize(rawSize);
+    raw.ok = decoder.decode(body.data, body.size, raw.bytes.data(), rawSize);
+    if (timed) raw.decodeNs = nowNs() - start;
+    return raw;
+}
+
+/**
+ * @brief HUF2 body (after the magic): frames until the end marker.
+ *
+ * Frame headers carry both sizes, so the reader hops from frame to frame
+ * without decoding; with a pool, bodies are decoded in parallel and written
+ * back in order through the same bounded window as the writer.  From a
+ * mapped input the bodies are decoded in place, without a staging copy.
+ */
+template <typename Source>
+static bool readHUF2(Source& in, ByteSink& out, unsigned threads,
+                     const Dictionary* dictionary, Stats* stats)
+{
+    uint32_t blockSize;
+    if (!in.read(&blockSize, sizeof(blockSize)) ||
+        blockSize == 0 || blockSize > MAX_BLOCK_SIZE)
+        return false;
+
+    /* Worst case: 15-bit codes for every byte plus the block headers */
+    const std::size_t maxFrame = std::size_t(blockSize) * 2 + 1024;
+
+    std::unique_ptr<ThreadPool> pool;
+    if (threads > 1) pool = std::make_unique<ThreadPool>(threads);
+    const std::size_t window = pool ? 2 * std::size_t(pool->size()) : 0;
+    std::deque<std::future<Frame>> pending;
+
+    /* Checked frames chain into the whole-file CRC that follows the end
+     * marker.  Frame checksums are verified by the decoder itself, so a
+     * bad frame stops the read before any of its bytes are written. */
+    bool     checked = false;
+    uint32_t fileCrc = 0;
+
+    const bool timed = stats != nullptr;
+    auto emit = [&](const Frame& raw) {
+        if (stats) {
+            ++stats->frames;
+            stats->stageNs[Stats::DECODE] += raw.decodeNs;
+            stats->peakFrameBytes = std::max<uint64_t>(stats->peakFrameBytes,
+                                                       raw.bytes.size());
+        }
+        return raw.ok && out.write(raw.bytes.data(), raw.bytes.size());
+    };
+
+    for (;;) {
+        uint32_t sizes[2];   // rawSize, frameSize
+        if (!in.read(sizes, sizeof(sizes))) return false;   // missing end marker
+        if (sizes[0] == 0) {                                // end of stream
+            if (sizes[1] != 0) return false;
+            break;
+        }
+        if (sizes[0] > blockSize || sizes[1] > maxFrame) return false;
+
+        Chunk body;
+        if (in.take(sizes[1], body) != sizes[1]) return false;
+        const uint32_t rawSize = sizes[0];
+
+        uint32_t crc;
+        if (frameChecksum(body.data, body.size, crc)) {
+            checked = true;
+            fileCrc = crc32cCombine(fileCrc, crc, rawSize);
+        }
+
+        if (!pool) {
+            if (stats) stats->peakFramesInFlight = 1;
+            if (!emit(decodeFrame(body, rawSize, dictionary, timed))) return false;
+            continue;
+        }
+        if (pending.size() == window) {
+            if (!emit(pending.front().get())) return false;
+            pending.pop_front();
+        }
+        pending.push_back(pool->submit([body = std::move(body), rawSize, dictionary, timed] {
+            return decodeFrame(body, rawSize, dictionary, timed);
+        }));
+        if (stats)
+            stats->peakFramesInFlight = std::max<uint64_t>(stats->peakFramesInFlight,
+                                                           pending.size());
+    }
+    while (!pending.empty()) {
+        if (!emit(pending.front().get())) return false;
+        pending.pop_front();
+    }
+
+    /* A missing or different trailer means frames were lost or reordered */
+    if (checked) {
+        uint8_t trailer[CHECKSUM_TRAILER_SIZE];
+        uint32_t stored;
+        if (!in.read(trailer, sizeof(trailer)) ||
+            std::memcmp(trailer, MAGIC_CHECKSUM, 4) != 0)
+            return false;
+        std::memcpy(&stored, trailer + 4, sizeof(stored));
+        if (stored != fileCrc) return false;
+    }
+    return true;
+}
+
+/** @brief `readAt(pos, dst, n)` over an in-memory image, bounds-checked. */
+static auto memoryReader(const uint8_t* data, std::size_t size)
+{
+    return [data, size](uint64_t pos, void* dst, std::size_t n) {
+        if (pos > size || n > size - pos) return false;
+        std::memcpy(dst, data + pos, n);
+        return true;
+    };
+}
+
+/** @brief scanHUF2() over any random-access input (see extractFrom). */
+template <typename ReadAt>
+static uint64_t scanFrames(ReadAt readAt, uint64_t size)
+{
+    char magic[4];
+    if (size < 8 || !readAt(0, magic, 4) || std::memcmp(magic, MAGIC_HUF2, 4) != 0)
+        return 0;
+
+    uint64_t pos = 8;   // magic + block size
+    uint64_t total = 0;
+    while (pos <= size - 8) {
+        uint32_t sizes[2];
+        if (!readAt(pos, sizes, sizeof(sizes))) return 0;
+        pos += 8;
+        if (sizes[0] == 0) return total;
+        if (sizes[1] > size - pos) return 0;
+        total += sizes[0];
+        pos   += sizes[1];
+    }
+    return 0;
+}
+
+uint64_t util::scanHUF2(const uint8_t* data, std::size_t size)
+{
+    return scanFrames(memoryReader(data, size), size);
+}
+
+/**
+ * @brief extractRange() over any random-access input.
+ *
+ * `readAt(pos, dst, n)` copies n bytes at file offset `pos`; `fileSize` is
+ * the size of the whole image.
+ */
+template <typename ReadAt>
+static bool extractFrom(ReadAt readAt, uint64_t fileSize, uint64_t offset, uint64_t length,
+                        std::vector<uint8_t>& out, const Dictionary* dictionary)
+{
+    out.clear();
+
+    /* 1. header and footer */
+    uint8_t header[8], footer[INDEX_FOOTER_SIZE];
+    if (fileSize < 8 + 8 + INDEX_FOOTER_SIZE ||
+        !readAt(0, header, sizeof(header)) ||
+        !readAt(fileSize - INDEX_FOOTER_SIZE, footer, sizeof(footer)) ||
+        std::memcmp(header, MAGIC_HUF2, 4) != 0 ||
+        std::memcmp(footer + 12, MAGIC_INDEX, 4) != 0)
+        return false;
+
+    uint32_t blockSize, frames;
+    uint64_t rawSize;
+    std::memcpy(&blockSize, header + 4, sizeof(blockSize));
+    std::memcpy(&rawSize, footer, sizeof(rawSize));
+    std::memcpy(&frames, footer + 8, sizeof(frames));
+    const uint64_t indexBytes = uint64_t(frames) * sizeof(uint64_t);
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE ||
+        frames != (rawSize + blockSize - 1) / blockSize ||
+        indexBytes > fileSize - 8 - 8 - INDEX_FOOTER_SIZE || offset > rawSize)
+        return false;
+
+    length = std::min(length, rawSize - offset);
+    if (length == 0) return true;
+
+    /* 2. index entries of the frames covering the range */
+    const uint64_t first = offset / blockSize;
+    const uint64_t last  = (offset + length - 1) / blockSize;
+    const uint64_t indexAt = fileSize - INDEX_FOOTER_SIZE - indexBytes;
+    std::vector<uint64_t> where(last - first + 1);
+    if (!readAt(indexAt + first * sizeof(uint64_t), where.data(),
+                where.size() * sizeof(uint64_t)))
+        return false;
+
+    /* 3. decode those frames and keep the requested slice */
+    BlockDecoder decoder;
+    decoder.setDictionary(dictionary);
+    std::vector<uint8_t> body, raw;
+    out.reserve(length);
+    for (uint64_t f = first; f <= last; ++f) {
+        const uint64_t pos   = where[f - first];
+        const uint64_t start = f * blockSize;
+        uint32_t sizes[2];   // rawSize, frameSize
+        if (pos < 8 || pos > indexAt - 8 || !readAt(pos, sizes, sizeof(sizes)) ||
+            sizes[0] != std::min<uint64_t>(blockSize, rawSize - start) ||
+            sizes[1] > indexAt - pos - 8)
+            return false;
+
+        body.resize(sizes[1]);
+        raw.resize(sizes[0]);
+        if (!readAt(pos + 8, body.data(), body.size()) ||
+            !decoder.decode(body.data(), body.size(), raw.data(), raw.size()))
+            return false;
+
+        uint64_t from = std::max(offset, start) - start;
+        uint64_t to   = std::min<uint64_t>(offset + length - start, sizes[0]);
+        out.insert(out.end(), raw.begin() + from, raw.begin() + to);
+    }
+    return true;
+}
+
+bool util::extractRange(const std::string& compressedPath, uint64_t offset, uint64_t length,
+                        std::vector<uint8_t>& out, const Dictionary* dictionary)
+{
+    std::ifstream in(compressedPath, std::ios::binary | std::ios::ate);
     if (!in) return false;
+    const uint64_t fileSize = static_cast<uint64_t>(in.tellg());
 
-    /* 6. unpack bits to string */
-    std::string bits;
-    bits.reserve(bitCount);
-    for (uint64_t i = 0; i < bitCount; ++i) {
-        bool b = (buffer[i / 8] & (1 << (7 - (i % 8)))) != 0;
-        bits.push_back(b ? '1' : '0');
-    }
-
-    /* 7. rebuild tree & decode */
-    HuffmanNode* root = buildHuffmanTree(freqMap);
-    std::string decoded = decodeText(bits, root);
-    deleteTree(root);
-
-    /* 8. write output */
-    std::ofstream out(outputPath, std::ios::binary);
-    if (!out) return false;
-    out.write(decoded.data(),
-              static_cast<std::streamsize>(decoded.size()));
-    return static_cast<bool>(out);
+    auto readAt = [&in](uint64_t pos, void* dst, std::size_t n) {
+        in.seekg(static_cast<std::streamoff>(pos));
+        in.read(static_cast<char*>(dst), static_cast<std::streamsize>(n));
+        return static_cast<bool>(in);
+    };
+    return extractFrom(readAt, fileSize, offset, length, out, dictionary);
+}
+
+bool util::extractRange(const uint8_t* data, std::size_t size, uint64_t offset, uint64_t length,
+                        std::vector<uint8_t>& out, const Dictionary* dictionary)
+{
+    return extractFrom(memoryReader(data, size), size, offset, length, out, dictionary);
+}
+
+template <typename Source>
+static bool decompressBody(Source& in, ByteSink& out, unsigned threads,
+                           const Dictionary* dictionary, Stats* stats)
+{
+    /* 1. verify magic and pick the reader */
+    char magic[4];
+    if (!in.read(magic, 4)) return false;
+
+    if (std::memcmp(magic, MAGIC_HUF2, 4) == 0) {
+        bool ok = readHUF2(in, out, ThreadPool::resolve(threads), dictionary, stats);
+        return out.flush() && ok;
+    }
+
+    std::string decoded;
+    if (std::memcmp(magic, MAGIC_HUF1, 4) == 0) {
+        if (!readHUF1(in, decoded, stats)) return false;
+    } else if (std::memcmp(magic, MAGIC_HUF0, 4) == 0) {
+        if (!readHUF0(in, decoded, stats)) return false;
+    } else {
+        return false;
+    }
+
+    /* 2. write output */
+    return out.write(decoded.data(), decoded.size()) && out.flush();
+}
+
+template <typename Source>
+static bool decompressFrom(Source& in, ByteSink& out, unsigned threads,
+                           const Dictionary* dictionary, Stats* stats)
+{
+    if (stats) *stats = Stats();
+    const uint64_t start = stats ? nowNs() : 0;
+
+    MeteredSource<Source> source(in, stats);
+    MeteredSink           sink(out, stats);
+    bool ok = decompressBody(source, sink, threads, dictionary, stats);
+
+    if (stats) stats->totalNs = nowNs() - start;
+    return ok;
+}
+
+bool util::decompressStream(std::istream& in, std::ostream& out,
+                            unsigned threads, const Dictionary* dictionary,
+                            Stats* stats)
+{
+    StreamSource source(in);
+    StreamSink   sink(out);
+    return decompressFrom(source, sink, threads, dictionary, stats);
+}
+
+bool util::readCompressedFile(const std::string& compressedPath,
+                              const std::string& outputPath,
+                              unsigned threads, const Dictionary* dictionary,
+                              Stats* stats)
+{
+    /* Large inputs: reader thread → decoder → writer thread, as for writing */
+    ReadAhead ahead;
+    if (ahead.open(compressedPath) && usePipeline(ahead.size())) {
+        FileWriter out;
+        if (!out.open(outputPath)) return false;
+        out.preallocate(scanFrames([&ahead](uint64_t pos, void* dst, std::size_t n) {
+            return ahead.readAt(pos, dst, n);
+        }, ahead.size()));
+
+        bool ok;
+        {
+            AsyncWriter writer(out);
+            ahead.start(WRITE_BUFFER_SIZE);
+            PipelineSource source(ahead);
+            ok = decompressFrom(source, writer, threads, dictionary, stats);
+        }
+        return out.close() && ok;
+    }
+
+    MappedFile    mapped;
+    std::ifstream in;
+    if (!mapped.open(compressedPath)) {
+        in.open(compressedPath, std::ios::binary);
+        if (!in) return false;
+    }
+
+    FileWriter out;
+    if (!out.open(outputPath)) return false;
+
+    bool ok;
+    if (mapped.data()) {
+        out.preallocate(scanHUF2(mapped.data(), mapped.size()));
+        SpanSource source(mapped.data(), mapped.size());
+        ok = decompressFrom(source, out, threads, dictionary, stats);
+    } else {
+        StreamSource source(in);
+        ok = decompressFrom(source, out, threads, dictionary, stats);
+    }
+    return out.close() && ok;
 }
@@ -0,0 +1,178 @@
+#include "Compressor.h"
+#include "Checksum.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>           // std::memcpy, std::memcmp
+
+using namespace huffman;
+using namespace huffman::util;
+
+std::size_t huffman::compressBound(std::size_t size, const CompressOptions& options)
+{
+    if (options.blockSize == 0 || options.blockSize > MAX_BLOCK_SIZE) return 0;
+
+    /* ceil(a / s) <= floor(a / s) + 1 per frame, so the blocks of all
+     * frames add up to at most frames + size / subBlockSize */
+    std::size_t frames = (size + options.blockSize - 1) / options.blockSize;
+    std::size_t blocks = frames + (options.subBlockSize ? size / options.subBlockSize : 0);
+    std::size_t perBlock = 5 + DecodeTable::STREAMS - 1;
+
+    std::size_t index = options.seekable ? 8 * frames + INDEX_FOOTER_SIZE : 0;
+    std::size_t check = options.checksum
+                      ? CHECKSUM_BLOCK_SIZE * frames + CHECKSUM_TRAILER_SIZE : 0;
+
+    return 16 + size + 8 * frames + perBlock * blocks + index + check;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Compressor                                                        */
+/* ------------------------------------------------------------------ */
+
+Compressor::Compressor(const CompressOptions& options)
+    : options_(options), encoder_(options.maxCodeLen, options.streams)
+{
+    encoder_.setSubBlockSize(options.subBlockSize);
+    encoder_.setDictionary(options.dictionary);
+    encoder_.setTiming(options.stats != nullptr);
+    encoder_.setChecksum(options.checksum);
+}
+
+bool Compressor::compress(const uint8_t* src, std::size_t srcSize,
+                          uint8_t* dst, std::size_t dstCapacity, std::size_t& written)
+{
+    const std::size_t blockSize = options_.blockSize;
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE) return false;
+
+    uint8_t* out  = dst;
+    uint8_t* end  = dst + dstCapacity;
+    auto     put  = [&out, end](const void* data, std::size_t size) {
+        if (std::size_t(end - out) < size) return false;
+        std::memcpy(out, data, size);
+        out += size;
+        return true;
+    };
+
+    uint32_t bs = static_cast<uint32_t>(blockSize);
+    if (!put(MAGIC_HUF2, 4) || !put(&bs, sizeof(bs))) return false;
+
+    using Clock = std::chrono::steady_clock;
+    const Clock::time_point start = Clock::now();
+    Stats* const stats = options_.stats;
+    if (stats) *stats = Stats();
+    uint32_t fileCrc = 0;
+    for (std::size_t pos = 0; pos < srcSize;) {
+        std::size_t n = std::min(blockSize, srcSize - pos);
+        frame_.clear();
+        BlockStats blocks = encoder_.encode(src + pos, n, frame_);
+        uint32_t crc;
+        if (frameChecksum(frame_.data(), frame_.size(), crc))
+            fileCrc = crc32cCombine(fileCrc, crc, n);
+        if (stats) {
+            *stats += blocks;
+            ++stats->frames;
+            stats->peakFrameBytes     = std::max<uint64_t>(stats->peakFrameBytes, frame_.size());
+            stats->peakFramesInFlight = 1;
+        }
+
+        uint32_t sizes[2] = { static_cast<uint32_t>(n), static_cast<uint32_t>(frame_.size()) };
+        if (!put(sizes, sizeof(sizes)) || !put(frame_.data(), frame_.size()))
+            return false;
+        pos += n;
+    }
+
+    /* end marker: rawSize = frameSize = 0 */
+    const std::size_t endMarker = static_cast<std::size_t>(out - dst);
+    uint32_t zero[2] = { 0, 0 };
+    if (!put(zero, sizeof(zero))) return false;
+
+    if (options_.checksum && !(put(MAGIC_CHECKSUM, 4) && put(&fileCrc, sizeof(fileCrc))))
+        return false;
+
+    if (options_.seekable) {
+        /* frame index: hop the headers just written */
+        uint32_t frames = 0;
+        for (std::size_t pos = 8; pos < endMarker; ++frames) {
+            uint64_t at = pos;
+            uint32_t frameSize;
+            std::memcpy(&frameSize, dst + pos + 4, sizeof(frameSize));
+            if (!put(&at, sizeof(at))) return false;
+            pos += 8 + frameSize;
+        }
+        uint64_t rawSize = srcSize;
+        if (!put(&rawSize, sizeof(rawSize)) || !put(&frames, sizeof(frames)) ||
+            !put(MAGIC_INDEX, 4))
+            return false;
+    }
+
+    written = static_cast<std::size_t>(out - dst);
+    if (stats) {
+        stats->inputBytes  = srcSize;
+        stats->outputBytes = written;
+        stats->totalNs     = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+    }
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/*  Decompressor                                                      */
+/* ------------------------------------------------------------------ */
+
+bool Decompressor::decompress(const uint8_t* src, std::size_t srcSize,
+                              uint8_t* dst, std::size_t dstCapacity, std::size_t& written)
+{
+    if (srcSize < 8 || std::memcmp(src, MAGIC_HUF2, 4) != 0) return false;
+
+    uint32_t blockSize;
+    std::memcpy(&blockSize, src + 4, sizeof(blockSize));
+    if (blockSize == 0 || blockSize > MAX_BLOCK_SIZE) return false;
+
+    std::size_t pos = 8, produced = 0, frames = 0;
+    bool     checked = false;
+    uint32_t fileCrc = 0;
+    for (;;) {
+        uint32_t sizes[2];   // rawSize, frameSize
+        if (srcSize - pos < sizeof(sizes)) return false;   // missing end marker
+        std::memcpy(sizes, src + pos, sizeof(sizes));
+        pos += sizeof(sizes);
+
+        if (sizes[0] == 0) {                                // end of image
+            if (sizes[1] != 0) return false;
+            break;
+        }
+        if (sizes[0] > blockSize || sizes[1] > srcSize - pos ||
+            sizes[0] > dstCapacity - produced)
+            return false;
+
+        if (!decoder_.decode(src + pos, sizes[1], dst + produced, sizes[0]))
+            return false;
+        uint32_t crc;
+        if (frameChecksum(src + pos, sizes[1], crc)) {
+            checked = true;
+            fileCrc = crc32cCombine(fileCrc, crc, sizes[0]);
+        }
+        pos      += sizes[1];
+        produced += sizes[0];
+        ++frames;
+    }
+
+    /* the whole-image CRC comes next; checked frames require it */
+    if (srcSize - pos >= CHECKSUM_TRAILER_SIZE &&
+        std::memcmp(src + pos, MAGIC_CHECKSUM, 4) == 0) {
+        uint32_t stored;
+        std::memcpy(&stored, src + pos + 4, sizeof(stored));
+        if (stored != fileCrc) return false;
+        pos += CHECKSUM_TRAILER_SIZE;
+    } else if (checked) {
+        return false;
+    }
+
+    /* only the frame index of a seekable image may follow */
+    if (pos != srcSize &&
+        (srcSize - pos != 8 * frames + INDEX_FOOTER_SIZE ||
+         std::memcmp(src + srcSize - 4, MAGIC_INDEX, 4) != 0))
+        return false;
+    written = produced;
+    return true;
+}
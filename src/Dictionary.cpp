@@ -0,0 +1,83 @@
+#include "Dictionary.h"
+#include "HuffmanTree.h"     // buildCodeLengths()
+
+#include <algorithm>
+#include <cstring>           // std::memcmp
+#include <fstream>
+#include <iterator>
+#include <vector>
+
+using namespace huffman;
+
+/** @brief FNV-1a over the code lengths: the table's identity in a frame. */
+static uint32_t hashLengths(const CodeLengths& lengths)
+{
+    uint32_t h = 2166136261u;
+    for (uint8_t len : lengths) {
+        h ^= len;
+        h *= 16777619u;
+    }
+    return h;
+}
+
+void Dictionary::train(const Histogram& samples, unsigned maxCodeLen)
+{
+    Histogram counts = samples;
+    for (auto& c : counts) c = std::max<uint64_t>(c, 1);   // every byte gets a code
+
+    unsigned maxLen = std::clamp(maxCodeLen, 8u, MAX_STORED_CODE_LEN);
+    setLengths(buildCodeLengths(counts, maxLen));
+}
+
+bool Dictionary::setLengths(const CodeLengths& lengths)
+{
+    ready_ = false;
+    for (uint8_t len : lengths)
+        if (len == 0) return false;     // a table must code every byte
+
+    lengths_ = lengths;
+    codes_   = canonicalCodes(lengths);
+    if (!table_.build(codes_, true)) return false;   // built once, used by every block
+
+    id_    = hashLengths(lengths);
+    ready_ = true;
+    return true;
+}
+
+bool Dictionary::save(const std::string& path) const
+{
+    if (!ready_) return false;
+
+    std::vector<uint8_t> bytes(MAGIC_HUFT, MAGIC_HUFT + 4);
+    for (int i = 0; i < 4; ++i) bytes.push_back(uint8_t(id_ >> (8 * i)));
+    appendCodeLengths(bytes, lengths_);
+
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(bytes.data()),
+              static_cast<std::streamsize>(bytes.size()));
+    return static_cast<bool>(out);
+}
+
+bool Dictionary::load(const std::string& path)
+{
+    ready_ = false;
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    std::vector<uint8_t> bytes((std::istreambuf_iterator<char>(in)),
+                               std::istreambuf_iterator<char>());
+
+    if (bytes.size() < 8 || std::memcmp(bytes.data(), MAGIC_HUFT, 4) != 0)
+        return false;
+    uint32_t id = uint32_t(bytes[4]) | uint32_t(bytes[5]) << 8 |
+                  uint32_t(bytes[6]) << 16 | uint32_t(bytes[7]) << 24;
+
+    CodeLengths lengths;
+    std::size_t used = parseCodeLengths(bytes.data() + 8, bytes.size() - 8, lengths);
+    if (!used || 8 + used != bytes.size()) return false;
+
+    if (!setLengths(lengths)) return false;
+
+    /* the stored id must match the table, or frames would be misread */
+    if (id_ != id) return ready_ = false;
+    return true;
+}
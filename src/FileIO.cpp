@@ -0,0 +1,316 @@
+#include "FileIO.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>           // std::memcpy
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+using namespace huffman::util;
+
+/* ------------------------------------------------------------------ */
+/*  MappedFile                                                        */
+/* ------------------------------------------------------------------ */
+
+MappedFile::~MappedFile()
+{
+    if (data_)
+        munmap(const_cast<uint8_t*>(data_), size_);
+}
+
+bool MappedFile::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) ||
+        static_cast<uint64_t>(st.st_size) < MMAP_THRESHOLD) {
+        ::close(fd);
+        return false;
+    }
+
+    std::size_t size = static_cast<std::size_t>(st.st_size);
+    void* p = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);                      // the mapping keeps the file alive
+    if (p == MAP_FAILED) return false;
+
+    madvise(p, size, MADV_SEQUENTIAL);
+    data_ = static_cast<const uint8_t*>(p);
+    size_ = size;
+    return true;
+}
+
+/* ------------------------------------------------------------------ */
+/*  FileWriter                                                        */
+/* ------------------------------------------------------------------ */
+
+FileWriter::~FileWriter()
+{
+    close();
+}
+
+bool FileWriter::open(const std::string& path)
+{
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) return false;
+    buffer_.reserve(WRITE_BUFFER_SIZE);
+    return true;
+}
+
+bool FileWriter::writeAll(const uint8_t* data, std::size_t size)
+{
+    while (size > 0) {
+        ssize_t n = ::write(fd_, data, size);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            return ok_ = false;
+        }
+        data += n;
+        size -= static_cast<std::size_t>(n);
+        written_ += static_cast<uint64_t>(n);
+    }
+    return true;
+}
+
+bool FileWriter::write(const void* data, std::size_t size)
+{
+    if (fd_ < 0 || !ok_) return false;
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+
+    if (buffer_.size() + size > WRITE_BUFFER_SIZE && !flush()) return false;
+    if (size >= WRITE_BUFFER_SIZE) return writeAll(p, size);   // no staging copy
+
+    buffer_.insert(buffer_.end(), p, p + size);
+    return true;
+}
+
+bool FileWriter::flush()
+{
+    if (fd_ < 0 || !ok_) return false;
+    bool ok = writeAll(buffer_.data(), buffer_.size());
+    buffer_.clear();
+    return ok;
+}
+
+void FileWriter::preallocate(uint64_t bytes)
+{
+    if (fd_ < 0 || bytes <= preallocated_) return;
+    /* only a hint: filesystems without fallocate support just say no */
+    if (posix_fallocate(fd_, 0, static_cast<off_t>(bytes)) == 0)
+        preallocated_ = bytes;
+}
+
+bool FileWriter::close()
+{
+    if (fd_ < 0) return ok_;
+    flush();
+    if (preallocated_ > written_ &&
+        ftruncate(fd_, static_cast<off_t>(written_)) != 0)
+        ok_ = false;
+    if (::close(fd_) != 0) ok_ = false;
+    fd_ = -1;
+    return ok_;
+}
+
+/* ------------------------------------------------------------------ */
+/*  ReadAhead                                                         */
+/* ------------------------------------------------------------------ */
+
+ReadAhead::~ReadAhead()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    if (reader_.joinable()) reader_.join();
+    if (fd_ >= 0) ::close(fd_);
+}
+
+bool ReadAhead::open(const std::string& path)
+{
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        ::close(fd);
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+    fd_   = fd;
+    size_ = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+bool ReadAhead::readAt(uint64_t pos, void* dst, std::size_t n) const
+{
+    uint8_t* p = static_cast<uint8_t*>(dst);
+    while (n > 0) {
+        ssize_t got = ::pread(fd_, p, n, static_cast<off_t>(pos));
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        p   += got;
+        pos += static_cast<uint64_t>(got);
+        n   -= static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+void ReadAhead::start(std::size_t segmentSize)
+{
+    reader_ = std::thread([this, segmentSize] { readerLoop(segmentSize); });
+}
+
+void ReadAhead::readerLoop(std::size_t segmentSize)
+{
+    for (uint64_t pos = 0; pos < size_;) {
+        std::vector<uint8_t> segment;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this] { return stopping_ || ready_.size() < PIPELINE_DEPTH; });
+            if (stopping_) return;
+            if (!spare_.empty()) {
+                segment = std::move(spare_.back());
+                spare_.pop_back();
+            }
+        }
+
+        /* the file may shrink under us: then it simply ends early */
+        std::size_t n = static_cast<std::size_t>(std::min<uint64_t>(segmentSize, size_ - pos));
+        segment.resize(n);
+        bool ok = readAt(pos, segment.data(), n);
+        pos += n;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok) {
+            failed_ = true;
+            break;
+        }
+        ready_.push_back(std::move(segment));
+        changed_.notify_all();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    changed_.notify_all();
+}
+
+bool ReadAhead::next(std::vector<uint8_t>& segment)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return !ready_.empty() || done_; });
+    if (ready_.empty()) return false;
+
+    if (segment.capacity()) spare_.push_back(std::move(segment));   // for the reader
+    segment = std::move(ready_.front());
+    ready_.pop_front();
+    changed_.notify_all();
+    return true;
+}
+
+bool ReadAhead::failed() const
+{
+    std::lock_guard<std::mutex> lock(mutex_);
+    return failed_;
+}
+
+/* ------------------------------------------------------------------ */
+/*  AsyncWriter                                                       */
+/* ------------------------------------------------------------------ */
+
+AsyncWriter::AsyncWriter(ByteSink& out) : out_(out)
+{
+    current_.reserve(WRITE_BUFFER_SIZE);
+    writer_ = std::thread([this] { writerLoop(); });
+}
+
+AsyncWriter::~AsyncWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    changed_.notify_all();
+    writer_.join();
+}
+
+void AsyncWriter::writerLoop()
+{
+    for (;;) {
+        std::vector<uint8_t> buffer;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            changed_.wait(lock, [this] { return stopping_ || !queue_.empty(); });
+            if (queue_.empty()) return;   // stopping and drained
+            buffer = std::move(queue_.front());
+            queue_.pop_front();
+            busy_ = true;
+        }
+        changed_.notify_all();   // room in the queue
+
+        bool ok = out_.write(buffer.data(), buffer.size());
+        buffer.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!ok) ok_ = false;
+        spare_.push_back(std::move(buffer));
+        busy_ = false;
+        changed_.notify_all();
+    }
+}
+
+/** @brief Queue the current buffer (waiting for room) and start a fresh one. */
+void AsyncWriter::queueCurrent()
+{
+    if (current_.empty()) return;
+    std::unique_lock<std::mutex> lock(mutex_);
+    changed_.wait(lock, [this] { return queue_.size() < PIPELINE_DEPTH; });
+    queue_.push_back(std::move(current_));
+    if (!spare_.empty()) {
+        current_ = std::move(spare_.back());
+        spare_.pop_back();
+    } else {
+        current_ = std::vector<uint8_t>();
+        current_.reserve(WRITE_BUFFER_SIZE);
+    }
+    changed_.notify_all();
+}
+
+void AsyncWriter::waitIdle(std::unique_lock<std::mutex>& lock)
+{
+    changed_.wait(lock, [this] { return queue_.empty() && !busy_; });
+}
+
+bool AsyncWriter::write(const void* data, std::size_t size)
+{
+    const uint8_t* p = static_cast<const uint8_t*>(data);
+    while (size > 0) {
+        std::size_t n = std::min(size, WRITE_BUFFER_SIZE - current_.size());
+        current_.insert(current_.end(), p, p + n);
+        p    += n;
+        size -= n;
+        if (current_.size() == WRITE_BUFFER_SIZE) queueCurrent();
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    return ok_;
+}
+
+bool AsyncWriter::flush()
+{
+    queueCurrent();
+    std::unique_lock<std::mutex> lock(mutex_);
+    waitIdle(lock);
+    return out_.flush() && ok_;
+}
+
+void AsyncWriter::preallocate(uint64_t bytes)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    waitIdle(lock);
+    out_.preallocate(bytes);
+}
@@ -1,37 +1,62 @@
 #include "HuffmanCodes.h"
 
-/**
- * @brief Función recursiva auxiliar para recorrer el árbol y construir los códigos.
- *
- * @param node Puntero al nodo actual.
- * @param currentCode Código binario acumulado hasta este nodo.
- * @param codes Mapa donde se almacenan los pares (carácter -> código binario).
- */
-
-static void buildCodes(HuffmanNode* node, const std::string& currentCode, std::unordered_map<char, std::string>& codes) {
-    if (!node) {
-        return;
+CodeTable generateHuffmanCodes(const HuffmanTree& tree) {
+    CodeTable table{};
+    if (tree.empty()) {
+        return table;
     }
 
-    // Si el nodo hoja (sin hijos), almacenamos el código en el mapa
-    if (!node->left && !node->right) {
-        // Asignar el código al carácter
-        codes[node->character] = currentCode;
-        return;
+    // Un árbol de una sola hoja no tiene ramas: se le da el código "0"
+    if (tree[tree.root].isLeaf()) {
+        table[static_cast<unsigned char>(tree[tree.root].character)] = { 0, 1 };
+        return table;
     }
 
-    // Recorrer la rama izquierda, añadiendo '0'
-    buildCodes(node->left, currentCode + "0", codes);
+    // Los hijos preceden a su padre: recorriendo desde la raíz hacia índices
+    // menores, el código de cada nodo ya está calculado cuando se visita.
+    std::array<Code, 2 * 256 - 1> path;
+    path[tree.root] = Code{};
+    for (std::size_t i = tree.root + 1u; i-- > 0;) {
+        const HuffmanNode& node = tree.nodes[i];
+
+        // Si el nodo es hoja (sin hijos), su camino es el código del símbolo
+        if (node.isLeaf()) {
+            table[static_cast<unsigned char>(node.character)] = path[i];
+            continue;
+        }
+
+        // Rama izquierda añade un 0, rama derecha un 1
+        const Code& here = path[i];
+        uint8_t len = static_cast<uint8_t>(here.len + 1);
+        path[node.left]  = { here.bits << 1,       len };
+        path[node.right] = { (here.bits << 1) | 1, len };
+    }
 
-    // Recorrer la rama derecha, añadiendo '1'
-    buildCodes(node->right, currentCode + "1", codes);
+    return table;
 }
 
-std::unordered_map<char, std::string> generateHuffmanCodes(HuffmanNode* root) {
-    std::unordered_map<char, std::string> codes;
+CodeTable canonicalCodes(const CodeLengths& lengths) {
+    CodeTable table{};
+
+    // Cuántos símbolos hay de cada longitud
+    std::array<uint32_t, 65> count{};
+    for (uint8_t len : lengths)
+        if (len) ++count[len];
 
-    // Llamada a la función recursiva para construir los códigos
-    buildCodes(root, "", codes);
+    // Primer código de cada longitud (como en DEFLATE, RFC 1951 §3.2.2)
+    std::array<uint64_t, 65> next{};
+    uint64_t code = 0;
+    for (unsigned len = 1; len < next.size(); ++len) {
+        code = (code + count[len - 1]) << 1;
+        next[len] = code;
+    }
 
-    return codes;
+    // Asignar en orden de byte dentro de cada longitud
+    for (unsigned s = 0; s < lengths.size(); ++s) {
+        uint8_t len = lengths[s];
+        if (!len) continue;
+        table[s].bits = next[len]++;
+        table[s].len  = len;
+    }
+    return table;
 }
@@ -1,27 +1,377 @@
 #include "HuffmanDecoder.h"
 
-std::string decodeText(const std::string& encoded, HuffmanNode* root) {
+#include <algorithm>
+#include <cstring>   // std::memcpy
+
+std::string decodeText(const std::string& encoded, const HuffmanTree& tree) {
     std::string decoded;
-    if (!root) {
+    if (tree.empty()) {
         return decoded; // Si el árbol está vacío, retornamos cadena vacía
     }
+    if (tree[tree.root].isLeaf()) {
+        // Un solo símbolo: cada bit (código "0") es una aparición
+        return std::string(encoded.size(), tree[tree.root].character);
+    }
 
-    HuffmanNode* current = root;
+    uint16_t current = tree.root;
     for (char bit : encoded) {
         // Desplazarnos en el árbol según el bit
         if (bit == '0') {
-            current = current->left;
+            current = tree[current].left;
         } else { // bit == '1'
-            current = current->right;
+            current = tree[current].right;
+        }
+        // Árbol mal formado (nodo con un solo hijo): paramos en vez de salirnos
+        if (current >= tree.nodes.size()) {
+            break;
         }
 
         // Si llegamos a un nodo hoja, agregamos el carácter al resultado
-        if (current->left == nullptr && current->right == nullptr) {
-            decoded.push_back(current->character);
+        if (tree[current].isLeaf()) {
+            decoded.push_back(tree[current].character);
             // Volvemos a la raíz para decodificar el siguiente símbolo
-            current = root;
+            current = tree.root;
         }
     }
 
     return decoded;
 }
+
+/** @brief Máscara con los `n` bits bajos a 1 (n <= 64). */
+static uint64_t lowMask(unsigned n)
+{
+    return n >= 64 ? ~uint64_t(0) : (uint64_t(1) << n) - 1;
+}
+
+bool DecodeTable::build(const CodeTable& codes, bool multiSymbol)
+{
+    pending_.clear();
+    multi_.clear();
+    minLen_ = 64;
+    maxLen_ = 0;
+    for (unsigned s = 0; s < codes.size(); ++s) {
+        if (codes[s].len == 0) continue;
+        pending_.push_back({ codes[s].bits, codes[s].len, static_cast<uint8_t>(s) });
+        minLen_ = std::min<unsigned>(minLen_, codes[s].len);
+        maxLen_ = std::max<unsigned>(maxLen_, codes[s].len);
+    }
+    if (pending_.empty()) return false;
+
+    /* Orden por código alineado a la izquierda: los que comparten prefijo
+     * quedan contiguos y cada sub-tabla recibe un tramo, sin copias. */
+    std::sort(pending_.begin(), pending_.end(), [](const Pending& a, const Pending& b) {
+        return (a.bits << (64 - a.len)) < (b.bits << (64 - b.len));
+    });
+
+    /* Raíz del ancho de un núcleo especializado si todo cabe en ella */
+    if (maxLen_ <= 8)       { rootBits_ = 8;          kernel_ = ROOT8; }
+    else if (maxLen_ <= 11) { rootBits_ = 11;         kernel_ = ROOT11; }
+    else if (maxLen_ <= 12) { rootBits_ = 12;         kernel_ = ROOT12; }
+    else                    { rootBits_ = TABLE_BITS; kernel_ = GENERAL; }
+    static_assert(TABLE_BITS == 12, "los núcleos ROOTn suponen TABLE_BITS = 12");
+
+    entries_.assign(std::size_t(1) << rootBits_, Entry{});
+    if (!fill(0, rootBits_, 0, pending_.data(), pending_.data() + pending_.size()))
+        return false;
+
+    /* Sin sub-tablas y con al menos dos códigos cortos por entrada */
+    if (multiSymbol && kernel_ != GENERAL && 2 * minLen_ <= rootBits_) buildMulti();
+    return true;
+}
+
+/**
+ * @brief Deriva la tabla multi-símbolo de la raíz.
+ *
+ * Para cada índice se decodifican códigos mientras quepan enteros en los
+ * bits del propio índice: tras consumir `used` bits, la raíz consultada con
+ * (índice << used) sólo es fiable si el código encontrado no pasa de los
+ * rootBits_ - used bits reales (el resto del índice son ceros de relleno).
+ */
+void DecodeTable::buildMulti()
+{
+    const unsigned    root = rootBits_;
+    const std::size_t mask = (std::size_t(1) << root) - 1;
+    multi_.assign(std::size_t(1) << root, MultiEntry{});
+
+    for (std::size_t x = 0; x <= mask; ++x) {
+        MultiEntry& m    = multi_[x];
+        unsigned    used = 0;
+        while (m.count < MULTI_SYMBOLS) {
+            const Entry& e = entries_[(x << used) & mask];
+            if (e.kind != LEAF || used + e.len > root) break;
+            m.symbols[m.count++] = static_cast<uint8_t>(e.value);
+            used += e.len;
+        }
+        m.len = static_cast<uint8_t>(used);
+    }
+}
+
+/**
+ * @brief Rellena la tabla que empieza en `offset` (ancho `width` bits) con los
+ *        códigos de [first, last), cuyos primeros `depth` bits ya se
+ *        consumieron en niveles previos.
+ *
+ * Un código que termina dentro de esta tabla ocupa 2^(width - resto) entradas;
+ * los que siguen más allá forman tramos contiguos por prefijo y cada tramo
+ * genera una sub-tabla.
+ */
+bool DecodeTable::fill(std::size_t offset, unsigned width, unsigned depth,
+                       const Pending* first, const Pending* last)
+{
+    for (const Pending* c = first; c != last; ++c) {
+        unsigned rest = c->len - depth;
+        if (rest > width) continue;
+
+        uint64_t    tail = c->bits & lowMask(rest);
+        std::size_t base = offset + (std::size_t(tail) << (width - rest));
+        std::size_t span = std::size_t(1) << (width - rest);
+        for (std::size_t i = 0; i < span; ++i) {
+            Entry& e = entries_[base + i];
+            if (e.kind != EMPTY) return false;           // código no prefijo
+            e.value = c->symbol;
+            e.len   = static_cast<uint8_t>(rest);
+            e.kind  = LEAF;
+        }
+    }
+
+    /* Primeros `width` bits pendientes de un código que no cabe aquí */
+    auto prefixOf = [depth, width](const Pending& c) {
+        unsigned rest = c.len - depth;
+        return uint32_t((c.bits & lowMask(rest)) >> (rest - width));
+    };
+
+    for (const Pending* c = first; c != last;) {
+        if (c->len - depth <= width) { ++c; continue; }
+
+        uint32_t       prefix  = prefixOf(*c);
+        unsigned       longest = c->len;
+        const Pending* end     = c + 1;
+        for (; end != last && end->len - depth > width && prefixOf(*end) == prefix; ++end)
+            longest = std::max(longest, end->len);
+
+        /* Un tramo partido (o una hoja encima) deja la entrada ocupada */
+        if (entries_[offset + prefix].kind != EMPTY) return false;
+        unsigned subBits = std::min(longest - depth - width, TABLE_BITS);
+
+        std::size_t subOffset = entries_.size();
+        entries_.resize(subOffset + (std::size_t(1) << subBits));
+
+        Entry& link  = entries_[offset + prefix];
+        link.value   = static_cast<uint32_t>(subOffset);
+        link.len     = static_cast<uint8_t>(width);
+        link.kind    = SUB;
+        link.subBits = static_cast<uint8_t>(subBits);
+
+        if (!fill(subOffset, subBits, depth + width, c, end)) return false;
+        c = end;
+    }
+    return true;
+}
+
+template <unsigned RootBits>
+std::size_t DecodeTable::decodeFast(BitReader& in, uint8_t* out, std::size_t count,
+                                    bool& ok) const
+{
+    constexpr unsigned PER_REFILL = 56 / RootBits;   // códigos que garantiza un refill
+    const Entry* table = entries_.data();
+
+    std::size_t i = 0;
+    for (; ok && i + PER_REFILL <= count && in.canRefillFast(); i += PER_REFILL) {
+        in.refillFast();
+        for (unsigned k = 0; k < PER_REFILL; ++k) {   // constante: se desenrolla
+            const Entry& e = table[in.peek(RootBits)];
+            ok &= e.kind == LEAF;
+            out[i + k] = static_cast<uint8_t>(e.value);
+            in.consume(e.len);
+        }
+    }
+    return i;
+}
+
+template <unsigned RootBits>
+std::size_t DecodeTable::decodeMulti(BitReader& in, uint8_t* out, std::size_t count,
+                                     bool& ok) const
+{
+    constexpr unsigned PER_REFILL = 56 / RootBits;   // cada consulta gasta <= RootBits
+    const MultiEntry* table = multi_.data();
+
+    /* Cada consulta copia MULTI_SYMBOLS bytes aunque emita menos: el margen
+     * garantiza que la copia no pasa de `count`. */
+    std::size_t i = 0;
+    while (ok && i + PER_REFILL * MULTI_SYMBOLS <= count && in.canRefillFast()) {
+        in.refillFast();
+        for (unsigned k = 0; k < PER_REFILL; ++k) {
+            const MultiEntry& m = table[in.peek(RootBits)];
+            ok &= m.count != 0;
+            std::memcpy(out + i, m.symbols, MULTI_SYMBOLS);
+            i += m.count;
+            in.consume(m.len);
+        }
+    }
+    return i;
+}
+
+bool DecodeTable::decode(BitReader& stream, uint8_t* out, std::size_t count) const
+{
+    /* Copia local: las escrituras por uint8_t* pueden aliasar cualquier
+     * objeto, así que el estado del lector en memoria se recargaría tras
+     * cada símbolo; en una variable local queda en registros. */
+    BitReader      in    = stream;
+    const Entry*   table = entries_.data();
+    const unsigned root  = rootBits_;
+    bool           ok    = true;
+
+    /* Camino rápido: núcleo del ancho de la raíz, multi-símbolo si lo hay */
+    std::size_t i = 0;
+    if (!multi_.empty()) {
+        switch (kernel_) {
+        case ROOT8:   i = decodeMulti<8>(in, out, count, ok);  break;
+        case ROOT11:  i = decodeMulti<11>(in, out, count, ok); break;
+        case ROOT12:  i = decodeMulti<12>(in, out, count, ok); break;
+        case GENERAL: break;
+        }
+    }
+    switch (kernel_) {
+    case ROOT8:   i += decodeFast<8>(in, out + i, count - i, ok);  break;
+    case ROOT11:  i += decodeFast<11>(in, out + i, count - i, ok); break;
+    case ROOT12:  i += decodeFast<12>(in, out + i, count - i, ok); break;
+    case GENERAL: break;
+    }
+
+    /* Camino general (y cola del rápido): recorre sub-tablas si hace falta */
+    for (; ok && i < count; ++i) {
+        in.refill();
+        const Entry* e = &table[in.peek(root)];
+        while (e->kind == SUB) {
+            in.consume(e->len);
+            in.refill();
+            e = &table[e->value + in.peek(e->subBits)];
+        }
+        ok = e->kind == LEAF;
+        out[i] = static_cast<uint8_t>(e->value);
+        in.consume(e->len);
+    }
+    stream = in;
+    return ok;
+}
+
+template <unsigned RootBits>
+std::size_t DecodeTable::decode4Fast(BitReader (&in)[STREAMS], uint8_t* const (&dst)[STREAMS],
+                                     std::size_t len, bool& ok) const
+{
+    constexpr unsigned PER_REFILL = 56 / RootBits;
+    const Entry* table = entries_.data();
+
+    /* Lectores en variables locales, como en decode() */
+    BitReader r0 = in[0], r1 = in[1], r2 = in[2], r3 = in[3];
+    uint8_t *d0 = dst[0], *d1 = dst[1], *d2 = dst[2], *d3 = dst[3];
+
+    auto step = [&](BitReader& r, uint8_t* d) {
+        const Entry& e = table[r.peek(RootBits)];
+        ok &= e.kind == LEAF;
+        *d = static_cast<uint8_t>(e.value);
+        r.consume(e.len);
+    };
+
+    std::size_t i = 0;
+    for (; ok && i + PER_REFILL <= len &&
+           (r0.canRefillFast() & r1.canRefillFast() &
+            r2.canRefillFast() & r3.canRefillFast()); i += PER_REFILL) {
+        r0.refillFast(); r1.refillFast(); r2.refillFast(); r3.refillFast();
+        for (unsigned j = 0; j < PER_REFILL; ++j) {
+            step(r0, d0 + i + j);
+            step(r1, d1 + i + j);
+            step(r2, d2 + i + j);
+            step(r3, d3 + i + j);
+        }
+    }
+    in[0] = r0; in[1] = r1; in[2] = r2; in[3] = r3;
+    return i;
+}
+
+template <unsigned RootBits>
+void DecodeTable::decode4Multi(BitReader (&in)[STREAMS], uint8_t* const (&dst)[STREAMS],
+                               const std::size_t (&len)[STREAMS],
+                               std::size_t (&done)[STREAMS], bool& ok) const
+{
+    constexpr unsigned    PER_REFILL = 56 / RootBits;
+    constexpr std::size_t MARGIN     = PER_REFILL * MULTI_SYMBOLS;
+    const MultiEntry* table = multi_.data();
+
+    BitReader   r0 = in[0], r1 = in[1], r2 = in[2], r3 = in[3];
+    uint8_t    *d0 = dst[0], *d1 = dst[1], *d2 = dst[2], *d3 = dst[3];
+    std::size_t i0 = 0, i1 = 0, i2 = 0, i3 = 0;
+
+    auto step = [&](BitReader& r, uint8_t* d, std::size_t& i) {
+        const MultiEntry& m = table[r.peek(RootBits)];
+        ok &= m.count != 0;
+        std::memcpy(d + i, m.symbols, MULTI_SYMBOLS);
+        i += m.count;
+        r.consume(m.len);
+    };
+
+    /* Los flujos avanzan a ritmos distintos: se para en cuanto a uno le
+     * falta margen y cada uno sigue luego su propia cola. */
+    while (ok && i0 + MARGIN <= len[0] && i1 + MARGIN <= len[1] &&
+           i2 + MARGIN <= len[2] && i3 + MARGIN <= len[3] &&
+           (r0.canRefillFast() & r1.canRefillFast() &
+            r2.canRefillFast() & r3.canRefillFast())) {
+        r0.refillFast(); r1.refillFast(); r2.refillFast(); r3.refillFast();
+        for (unsigned j = 0; j < PER_REFILL; ++j) {
+            step(r0, d0, i0);
+            step(r1, d1, i1);
+            step(r2, d2, i2);
+            step(r3, d3, i3);
+        }
+    }
+    in[0] = r0; in[1] = r1; in[2] = r2; in[3] = r3;
+    done[0] = i0; done[1] = i1; done[2] = i2; done[3] = i3;
+}
+
+bool DecodeTable::decode4(BitReader (&in)[STREAMS], uint8_t* out, std::size_t count) const
+{
+    const std::size_t seg = segmentSize(count);
+
+    uint8_t*    dst[STREAMS];
+    std::size_t len[STREAMS];
+    for (unsigned k = 0; k < STREAMS; ++k) {
+        std::size_t start = std::min(k * seg, count);
+        dst[k] = out + start;
+        len[k] = std::min(seg, count - start);
+    }
+
+    bool ok = true;
+    if (!multi_.empty()) {
+        std::size_t done[STREAMS] = {};
+        switch (kernel_) {
+        case ROOT8:   decode4Multi<8>(in, dst, len, done, ok);  break;
+        case ROOT11:  decode4Multi<11>(in, dst, len, done, ok); break;
+        case ROOT12:  decode4Multi<12>(in, dst, len, done, ok); break;
+        case GENERAL: break;
+        }
+        if (!ok) return false;
+
+        /* Colas: decode() sigue con el multi-símbolo flujo por flujo */
+        for (unsigned k = 0; k < STREAMS; ++k)
+            if (!decode(in[k], dst[k] + done[k], len[k] - done[k])) return false;
+        return true;
+    }
+
+    /* Camino rápido en paralelo mientras los cuatro segmentos tienen datos
+     * (el último es el más corto) y les quedan 8 bytes: un refill sin
+     * comprobaciones por flujo cada 56 / ancho símbolos. */
+    std::size_t i = 0;
+    const std::size_t common = len[STREAMS - 1];
+    switch (kernel_) {
+    case ROOT8:   i = decode4Fast<8>(in, dst, common, ok);  break;
+    case ROOT11:  i = decode4Fast<11>(in, dst, common, ok); break;
+    case ROOT12:  i = decode4Fast<12>(in, dst, common, ok); break;
+    case GENERAL: break;
+    }
+    if (!ok) return false;
+
+    /* Colas (y tablas con sub-niveles): flujo por flujo */
+    for (unsigned k = 0; k < STREAMS; ++k)
+        if (!decode(in[k], dst[k] + i, len[k] - i)) return false;
+    return true;
+}
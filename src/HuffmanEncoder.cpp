@@ -1,16 +1,70 @@
 #include "HuffmanEncoder.h"
+#include "BitReader.h"
 
-std::string encodeText(const std::string& text, const std::unordered_map<char, std::string>& codes) {
+#include <stdexcept>
+#include <vector>
+
+uint64_t encodedBitCount(const Histogram& hist, const CodeTable& table) {
+    uint64_t bits = 0;
+    for (unsigned s = 0; s < hist.size(); ++s)
+        bits += hist[s] * table[s].len;
+    return bits;
+}
+
+void encodePacked(const std::string& text, const CodeTable& table, BitWriter& out) {
+    encodePacked(reinterpret_cast<const uint8_t*>(text.data()), text.size(), table, out);
+}
+
+void encodePacked(const uint8_t* data, std::size_t size,
+                  const CodeTable& table, BitWriter& out) {
+    unsigned maxLen = 0;
+    for (const Code& c : table)
+        if (c.len > maxLen) maxLen = c.len;
+
+    if (maxLen <= 32) {
+        // Caso habitual: cada código cabe en una sola llamada a put()
+        for (std::size_t i = 0; i < size; ++i) {
+            const Code& k = table[data[i]];
+            out.put(uint32_t(k.bits), k.len);
+        }
+    } else {
+        for (std::size_t i = 0; i < size; ++i) {
+            const Code& k = table[data[i]];
+            out.putWide(k.bits, k.len);
+        }
+    }
+}
+
+std::string encodeText(const std::string& text, const CodeTable& table) {
+    uint64_t bitCount = 0;
+    for (unsigned char c : text) {
+        if (table[c].len == 0)
+            throw std::out_of_range("encodeText: character without code");
+        bitCount += table[c].len;
+    }
+
+    std::vector<uint8_t> packed((bitCount + 7) / 8);
+    BitWriter writer(packed.data());
+    encodePacked(text, table, writer);
+    writer.finish();
+
+    // Expandir a '0'/'1' sólo para mostrarlo en la demo
     std::string encoded;
-    encoded.reserve(text.size() * 2);
-    // Reserva inicial de memoria, para optimizar concatenaciones
-
-    for (char c : text) {
-        // Agregar la representación binaria correspondiente a cada carácter
-        encoded += codes.at(c);
-        // Se usa 'codes.at(c)' que lanza excepción si 'c' no está en el mapa
-        // (Podrías usar operator[] si quieres una versión sin excepción)
+    encoded.reserve(bitCount);
+    BitReader reader(packed.data(), packed.size());
+    for (uint64_t i = 0; i < bitCount; ++i) {
+        reader.refill();
+        encoded.push_back(reader.peek(1) ? '1' : '0');
+        reader.consume(1);
     }
 
     return encoded;
 }
+
+std::string codeToString(const Code& code) {
+    std::string str;
+    str.reserve(code.len);
+    for (unsigned i = code.len; i-- > 0;)
+        str.push_back((code.bits >> i) & 1 ? '1' : '0');
+    return str;
+}
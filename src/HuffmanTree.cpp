@@ -1,68 +1,211 @@
 #include "HuffmanTree.h"
+
+#include <algorithm>
+#include <array>
 #include <cstddef>   // std::size_t
 
-/** @brief Pequeño contenedor que agrupa un nodo y el orden (seq) en que se insertó
+/**
+ * @brief Une las hojas de `tree.nodes` (ya ordenadas) con dos colas FIFO.
+ *
+ * Las hojas ocupan [0, n) en orden creciente de frecuencia y los nodos
+ * internos se añaden detrás con frecuencias también crecientes, así que el
+ * propio arreglo contiene las dos colas: basta un cursor para cada una y el
+ * mínimo siempre está en alguna de las dos cabezas.  Coste O(n).
  *
- * Añadimos la secuencia para romper empates de forma determinista cuando dos
- * nodos tienen la misma frecuencia.  Así, el “min-heap” siempre extrae primero
- * el nodo que llegó antes, garantizando que el árbol resultante sea idéntico
- * en compresión y descompresión.
+ * Regla de empate (explícita): si la hoja y el nodo interno pesan lo mismo
+ * gana la hoja, y dentro de cada cola manda el orden de llegada.  Es el mismo
+ * orden que daba el heap con contador de secuencia, así que el árbol es
+ * idéntico al de versiones anteriores (el formato HUF0 depende de ello).
  */
-struct NodeWrap {
-    HuffmanNode* node;  ///< Puntero al nodo real del árbol
-    std::size_t  seq;   ///< Orden de inserción (creciente)
-};
+static void mergeSortedLeaves(HuffmanTree& tree)
+{
+    const std::size_t n = tree.nodes.size();
+    std::size_t leaf = 0, internal = n;   // cabezas de ambas colas
+
+    auto takeMin = [&]() -> uint16_t {
+        if (leaf < n && (internal == tree.nodes.size() ||
+                         tree.nodes[leaf].frequency <= tree.nodes[internal].frequency))
+            return static_cast<uint16_t>(leaf++);
+        return static_cast<uint16_t>(internal++);
+    };
+
+    for (std::size_t k = 1; k < n; ++k) {
+        uint16_t left  = takeMin();
+        uint16_t right = takeMin();
+        tree.addParent(left, right);
+    }
+    tree.root = static_cast<uint16_t>(tree.nodes.size() - 1);
+}
+
+void buildHuffmanTree(const Histogram& hist, HuffmanTree& tree)
+{
+    tree.clear();
+
+    /* 1. Símbolos presentes, ordenados por (frecuencia, byte): clave única */
+    std::array<uint8_t, 256> order;
+    std::size_t n = 0;
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s]) order[n++] = static_cast<uint8_t>(s);
+    if (n == 0) return;
+
+    std::sort(order.begin(), order.begin() + n, [&](uint8_t a, uint8_t b) {
+        return hist[a] != hist[b] ? hist[a] < hist[b] : a < b;
+    });
+
+    /* 2. Hojas en ese orden y fusión lineal */
+    tree.nodes.reserve(2 * n - 1);
+    for (std::size_t i = 0; i < n; ++i)
+        tree.addLeaf(static_cast<char>(order[i]), hist[order[i]]);
+    mergeSortedLeaves(tree);
+}
+
+void buildHuffmanTree(const std::vector<std::pair<char, uint64_t>>& leaves,
+                      HuffmanTree& tree)
+{
+    tree.clear();
+    const std::size_t n = leaves.size();
+    if (n == 0) return;
+
+    /* 1. Orden por frecuencia; en empate, por posición en `leaves` */
+    std::vector<uint16_t> order(n);
+    for (std::size_t i = 0; i < n; ++i) order[i] = static_cast<uint16_t>(i);
+    std::sort(order.begin(), order.end(), [&](uint16_t a, uint16_t b) {
+        return leaves[a].second != leaves[b].second
+            ? leaves[a].second < leaves[b].second : a < b;
+    });
 
-/** @brief Comparador estable para el heap de construcción del árbol
+    /* 2. Hojas en ese orden y fusión lineal */
+    tree.nodes.reserve(2 * n - 1);
+    for (uint16_t i : order)
+        tree.addLeaf(leaves[i].first, leaves[i].second);
+    mergeSortedLeaves(tree);
+}
+
+/**
+ * @brief Anota en `lengths` la profundidad de cada hoja del árbol.
  *
- * - Primero prioriza la menor frecuencia (`frequency`).
- * - Si las frecuencias son iguales, prioriza el menor `seq` (FIFO).
+ * Los hijos siempre preceden a su padre en el arreglo, así que basta un
+ * recorrido descendente desde la raíz (último índice) para propagar las
+ * profundidades sin recursión.
  */
-struct Compare {
-    bool operator()(const NodeWrap& a, const NodeWrap& b) const {
-        if (a.node->frequency != b.node->frequency)
-            return a.node->frequency > b.node->frequency;  // heap “min”
-        return a.seq > b.seq;                              // estable en empate
+static unsigned collectDepths(const HuffmanTree& tree, CodeLengths& lengths)
+{
+    uint16_t depth[2 * 256 - 1];
+    unsigned maxDepth = 0;
+    depth[tree.root] = 0;
+    for (std::size_t i = tree.root + 1; i-- > 0;) {
+        const HuffmanNode& n = tree.nodes[i];
+        if (n.isLeaf()) {
+            lengths[static_cast<unsigned char>(n.character)] =
+                static_cast<uint8_t>(depth[i]);
+            maxDepth = std::max<unsigned>(maxDepth, depth[i]);
+        } else {
+            depth[n.left] = depth[n.right] = depth[i] + 1;
+        }
     }
-};
+    return maxDepth;
+}
 
-/** @brief Construye un árbol de Huffman determinista a partir de un mapa de
- *         frecuencias.
+/**
+ * @brief Longitudes óptimas con límite `maxLen` mediante package-merge
+ *        (Larmore & Hirschberg, 1990).
  *
- * La función usa una `priority_queue` con un comparador estable, de modo que
- * para un mismo conjunto de frecuencias siempre se obtiene exactamente el
- * mismo árbol.  Esto evita que la fase de descompresión reconstruya un árbol
- * diferente cuando hay símbolos con igual frecuencia.
- *
- * @param freqMap Mapa (carácter → frecuencia) calculado previamente.
- * @return Puntero a la raíz del árbol (o `nullptr` si el mapa está vacío).
+ * Cada nivel fusiona las hojas (ordenadas por peso) con los "paquetes" que
+ * resultan de emparejar la lista del nivel anterior.  De la última lista se
+ * toman los 2n-2 elementos más ligeros; cada aparición de una hoja en esa
+ * selección (y en los prefijos que implican sus paquetes) suma 1 a su longitud.
+ * Requiere 2^maxLen >= n.
  */
-HuffmanNode* buildHuffmanTree(const std::unordered_map<char, int>& freqMap)
+static CodeLengths packageMerge(const Histogram& hist, unsigned maxLen)
 {
-    std::priority_queue<NodeWrap,
-                        std::vector<NodeWrap>,
-                        Compare> minHeap;
+    struct Leaf { uint64_t weight; uint8_t symbol; };
+
+    /* Listas reutilizadas entre bloques: tras el primero no se pide memoria */
+    thread_local std::vector<Leaf> leaves;
+    thread_local std::vector<std::vector<int>> kinds;
+    thread_local std::vector<uint64_t> weights, packages, merged;
 
-    static std::size_t SEQ = 0;   // contador global para romper empates
+    leaves.clear();
+    for (unsigned s = 0; s < hist.size(); ++s)
+        if (hist[s]) leaves.push_back({ hist[s], static_cast<uint8_t>(s) });
+    /* (peso, símbolo): mismo orden que un stable_sort, sin búfer temporal */
+    std::sort(leaves.begin(), leaves.end(), [](const Leaf& a, const Leaf& b) {
+        return a.weight != b.weight ? a.weight < b.weight : a.symbol < b.symbol;
+    });
+    const std::size_t n = leaves.size();
 
-    /* 1. Crear una hoja por cada símbolo */
-    for (auto const& [ch, freq] : freqMap) {
-        minHeap.push({ new HuffmanNode(ch, freq), SEQ++ });
+    /* kinds[l][k]: índice de hoja (>= 0) o paquete (-1) del k-ésimo elemento */
+    if (kinds.size() < maxLen) kinds.resize(maxLen);
+    for (unsigned l = 0; l < maxLen; ++l) kinds[l].clear();
+    weights.clear();
+
+    for (std::size_t i = 0; i < n; ++i) {
+        kinds[0].push_back(static_cast<int>(i));
+        weights.push_back(leaves[i].weight);
     }
 
-    /* 2. Combinar repetidamente los dos nodos de menor frecuencia */
-    while (minHeap.size() > 1) {
-        auto left  = minHeap.top(); minHeap.pop();
-        auto right = minHeap.top(); minHeap.pop();
+    for (unsigned l = 1; l < maxLen; ++l) {
+        packages.clear();
+        for (std::size_t i = 0; i + 1 < weights.size(); i += 2)
+            packages.push_back(weights[i] + weights[i + 1]);
 
-        auto parent = new HuffmanNode('\0',
-                                      left.node->frequency + right.node->frequency);
-        parent->left  = left.node;
-        parent->right = right.node;
+        /* Fusión estable: en empate, la hoja va antes que el paquete */
+        merged.clear();
+        std::size_t i = 0, j = 0;
+        while (i < n || j < packages.size()) {
+            if (j == packages.size() || (i < n && leaves[i].weight <= packages[j])) {
+                kinds[l].push_back(static_cast<int>(i));
+                merged.push_back(leaves[i++].weight);
+            } else {
+                kinds[l].push_back(-1);
+                merged.push_back(packages[j++]);
+            }
+        }
+        weights.swap(merged);
+    }
 
-        minHeap.push({ parent, SEQ++ });
+    /* Recorrer la selección de arriba abajo */
+    CodeLengths lengths{};
+    std::size_t take = 2 * n - 2;
+    for (unsigned l = maxLen; l-- > 0;) {
+        std::size_t pkgs = 0;
+        for (std::size_t k = 0; k < take; ++k) {
+            int kind = kinds[l][k];
+            if (kind >= 0) ++lengths[leaves[kind].symbol];
+            else           ++pkgs;
+        }
+        take = 2 * pkgs;
     }
+    return lengths;
+}
+
+CodeLengths buildCodeLengths(const Histogram& hist, unsigned maxLen,
+                             uint64_t* optimalBits)
+{
+    CodeLengths lengths{};
+    if (optimalBits) *optimalBits = 0;
+
+    /* Huffman sin límite: si ya cabe, es también el óptimo limitado */
+    thread_local HuffmanTree tree;   // arena reutilizada entre bloques
+    buildHuffmanTree(hist, tree);
+    if (tree.empty()) return lengths;
+
+    const std::size_t symbols = (tree.nodes.size() + 1) / 2;
+    if (symbols == 1) {
+        const HuffmanNode& only = tree[tree.root];
+        lengths[static_cast<unsigned char>(only.character)] = 1;
+        if (optimalBits) *optimalBits = only.frequency;
+        return lengths;
+    }
+    unsigned maxDepth = collectDepths(tree, lengths);
+
+    if (optimalBits)
+        for (unsigned s = 0; s < hist.size(); ++s)
+            *optimalBits += hist[s] * lengths[s];
+    if (maxDepth <= maxLen) return lengths;
 
-    /* 3. La raíz del árbol es el único nodo restante */
-    return minHeap.empty() ? nullptr : minHeap.top().node;
+    /* 2^maxLen debe alcanzar para todos los símbolos */
+    unsigned minLen = 1;
+    while ((std::size_t(1) << minLen) < symbols) ++minLen;
+    return packageMerge(hist, std::max(maxLen, minLen));
 }
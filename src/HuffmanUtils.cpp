@@ -9,42 +9,63 @@
 #include <algorithm>
 
 #include <array>           // paleta de colores ANSI
-#include <unordered_map>   // tipo freqMap
+#include <tuple>           // buildPretty()
 
 #include <fstream>
 #include <stdexcept>
 
 /**
- * @brief Libera la memoria de un árbol de Huffman
- *
- * @param node Puntero al nodo raíz del árbol.
- */
-void deleteTree(HuffmanNode* node) {
-    if (!node) return;              // Si el nodo es nullptr, no hace nada
-    deleteTree(node->left);         // Liberar el subárbol izquierdo
-    deleteTree(node->right);        // Liberal el subárbol derecho
-    delete node;                    // Liberar el nodo actual
-}
-
-
-/**
- * @brief Muestra estadísticas de compresión de texto usando Huffman.
- *
- * Calcula el número de bits en el texto original (asumiendo ASCII, 8 bits por carácter),
- * el número de bits codificados (tamaño de la cadena binaria),
- * y el porcentaje de ahorro de espacio tras la compresión.
- *
- * @param original Texto original sin comprimir.
- * @param encoded Texto codificado como cadena de bits ('0' y '1').
+ * @brief Imprime un objeto Stats: tamaños, bloques, códigos, memoria pico y
+ *        tiempo por etapa.
  */
-void reportCompressionStats(const std::string& original, const std::string& encoded) {
-    std::size_t originalBits = original.size() * 8;
-    std::size_t encodedBits = encoded.size();
-    double ahorro = (1.0 - static_cast<double>(encodedBits) / originalBits) * 100.0;
-
-    std::cout << "\nBits originales : " << originalBits << " bits";
-    std::cout << "\nBits codificados: " << encodedBits  << " bits";
-    std::cout << "\nAhorro          : " << std::fixed << std::setprecision(2) << ahorro << "%\n";
+void printStats(const huffman::util::Stats& stats, std::ostream& out)
+{
+    using huffman::util::Stats;
+    static const char* const STAGES[Stats::STAGE_COUNT] = {
+        "read", "histogram", "tree", "encode", "decode", "write"
+    };
+    static const char* const BLOCKS[huffman::BLOCK_TYPES] = {
+        "", "huffman", "huffman4", "raw", "reuse", "reuse4", "rle", "dict", "dict4",
+        "checksum"
+    };
+    auto mb = [](uint64_t bytes) { return double(bytes) / 1e6; };
+
+    std::ostringstream text;   // no tocar el formato de `out`
+    text << std::fixed << std::setprecision(2);
+
+    text << "  bytes in " << stats.inputBytes << ", out " << stats.outputBytes;
+    if (stats.inputBytes)
+        text << " (" << 100.0 * double(stats.outputBytes) / double(stats.inputBytes) << " %)";
+    text << '\n';
+
+    if (stats.frames) {
+        text << "  frames " << stats.frames;
+        const char* sep = ", blocks: ";
+        for (unsigned t = 1; t < huffman::BLOCK_TYPES; ++t)
+            if (stats.blocks[t]) {
+                text << sep << BLOCKS[t] << ' ' << stats.blocks[t];
+                sep = " ";
+            }
+        text << "\n  peak frame buffer " << mb(stats.peakFrameBytes) << " MB, "
+             << stats.peakFramesInFlight << " frame(s) in flight\n";
+    }
+    if (stats.codedSymbols)
+        text << "  coded symbols " << stats.codedSymbols << ", code length avg "
+             << stats.avgCodeLen() << " max " << stats.maxCodeLen << " bits\n";
+
+    for (unsigned s = 0; s < Stats::STAGE_COUNT; ++s) {
+        if (!stats.stageNs[s]) continue;
+        text << "  " << std::left << std::setw(10) << STAGES[s] << std::right
+             << std::setw(10) << double(stats.stageNs[s]) / 1e6 << " ms\n";
+    }
+    if (stats.totalNs) {
+        double seconds = double(stats.totalNs) / 1e9;
+        text << "  " << std::left << std::setw(10) << "total" << std::right
+             << std::setw(10) << seconds * 1e3 << " ms  (in "
+             << mb(stats.inputBytes) / seconds << " MB/s, out "
+             << mb(stats.outputBytes) / seconds << " MB/s)\n";
+    }
+    out << text.str();
 }
 
 
@@ -83,13 +104,13 @@ void writeBitStringToFile(const std::string& path, const std::string& bits)
  * Basado en la idea de https://stackoverflow.com/a/14648290
  */
 static std::tuple<std::vector<std::string>, int, int, int>
-buildPretty(const HuffmanNode* node)
+buildPretty(const HuffmanTree& tree, uint16_t index)
 {
-    if (!node) return { {}, 0, 0, 0 };
+    const HuffmanNode* node = &tree[index];
 
     // Etiqueta para este nodo
     std::ostringstream oss;
-    if (!node->left && !node->right)
+    if (node->isLeaf())
         oss << "('" << node->character << "', " << node->frequency << ")";
     else
         oss << "(*, " << node->frequency << ")";
@@ -97,12 +118,12 @@ buildPretty(const HuffmanNode* node)
     int labelW = static_cast<int>(label.size());
 
     // Caso base: hoja
-    if (!node->left && !node->right)
+    if (node->isLeaf())
         return { { label }, labelW, labelW / 2, 1 };
 
     // Construir hijos
-    auto [leftLines,  leftW,  leftMid,  leftH ] = buildPretty(node->left);
-    auto [rightLines, rightW, rightMid, rightH] = buildPretty(node->right);
+    auto [leftLines,  leftW,  leftMid,  leftH ] = buildPretty(tree, node->left);
+    auto [rightLines, rightW, rightMid, rightH] = buildPretty(tree, node->right);
 
     int gap = 3;                                  // espacio mínimo entre sub‑árboles
     int width  = leftW + gap + rightW;
@@ -115,8 +136,8 @@ buildPretty(const HuffmanNode* node)
     lines[0].replace(mid - labelW / 2, labelW, label);
 
     // Ramas “/” y “\”
-    if (node->left)  lines[1][leftMid]                = '/';
-    if (node->right) lines[1][leftW + gap + rightMid] = '\\';
+    lines[1][leftMid]                = '/';
+    lines[1][leftW + gap + rightMid] = '\\';
 
     // Copiar sub‑líneas
     for (int i = 0; i < leftH; ++i)
@@ -130,11 +151,12 @@ buildPretty(const HuffmanNode* node)
 /**
  * @brief Imprime el árbol de Huffman con ramas diagonales “/ \” y nodos centrados.
  *
- * @param root Puntero a la raíz del árbol.
+ * @param tree Árbol de Huffman (no imprime nada si está vacío).
  */
-void printHuffmanTreePretty(const HuffmanNode* root)
+void printHuffmanTreePretty(const HuffmanTree& tree)
 {
-    auto [lines, width, mid, height] = buildPretty(root);
+    if (tree.empty()) return;
+    auto [lines, width, mid, height] = buildPretty(tree, tree.root);
     for (const auto& l : lines) std::cout << l << '\n';
 }
 
@@ -149,28 +171,28 @@ static const std::array<const char*, 6> COLORS = {
  * @brief Imprime un histograma ASCII a color con las frecuencias de caracteres.
  *
  * Cada barra se dibuja con el bloque Unicode U+2588 y un color ANSI diferente.
- * @param freqMap Mapa (carácter -> frecuencia).
+ * @param hist Frecuencia de cada byte (sólo se muestran los presentes).
  */
-void printFrequencyHistogram(const std::unordered_map<char,int>& freqMap)
+void printFrequencyHistogram(const Histogram& hist)
 {
-    if (freqMap.empty()) return;
-
-    int maxFreq = 0;
-    for (auto& kv : freqMap)
-        maxFreq = std::max(maxFreq, kv.second);
+    uint64_t maxFreq = 0;
+    for (uint64_t f : hist)
+        maxFreq = std::max(maxFreq, f);
+    if (maxFreq == 0) return;
 
     const int BAR_WIDTH = 40;
     std::cout << "\nFrecuencia de caracteres\n------------------------\n";
 
     int colorIdx = 0;
-    for (auto& kv : freqMap) {
-        double ratio  = static_cast<double>(kv.second) / maxFreq;
+    for (unsigned s = 0; s < hist.size(); ++s) {
+        if (!hist[s]) continue;
+        double ratio  = static_cast<double>(hist[s]) / maxFreq;
         int blocks    = static_cast<int>(ratio * BAR_WIDTH);
         const char* c = COLORS[colorIdx++ % COLORS.size()];
 
-        std::cout << "'" << kv.first << "' | "
+        std::cout << "'" << static_cast<char>(s) << "' | "
         << c << std::string(blocks, '#') << "\033[0m "
-        << kv.second << '\n';
+        << hist[s] << '\n';
 
 
     }
@@ -181,41 +203,13 @@ void printFrequencyHistogram(const std::unordered_map<char,int>& freqMap)
 /* ------------------------------------------------------------------ */
 #include <sstream>   // para std::ostringstream
 
-/** @brief Función recursiva para recorrer el árbol y emitir nodos/aristas. */
-static void dotHelper(const HuffmanNode* node,
-                      std::ofstream& out,
-                      int& counter)
-{
-    if (!node) return;
-    int thisId = counter++;
-
-    std::ostringstream label;
-    if (!node->left && !node->right)
-        label << node->character << " (" << node->frequency << ")";
-    else
-        label << "*" << " (" << node->frequency << ")";
-
-    out << "  n" << thisId << " [label=\"" << label.str() << "\"];\n";
-
-    if (node->left) {
-        int childId = counter;
-        dotHelper(node->left, out, counter);
-        out << "  n" << thisId << " -> n" << childId << " [label=\"0\"];\n";
-    }
-    if (node->right) {
-        int childId = counter;
-        dotHelper(node->right, out, counter);
-        out << "  n" << thisId << " -> n" << childId << " [label=\"1\"];\n";
-    }
-}
-
 /** @brief Exporta el árbol a un archivo DOT para Graphviz.
  *
  * Luego puedes hacer:
  *     dot -Tsvg tree.dot -o tree.svg
  * para obtener la visualización en SVG.
  */
-void exportTreeToDot(const HuffmanNode* root,
+void exportTreeToDot(const HuffmanTree& tree,
                      const std::string& dotPath)
 {
     std::ofstream out(dotPath);
@@ -225,8 +219,22 @@ void exportTreeToDot(const HuffmanNode* root,
     }
     out << "digraph Huffman {\n"
            "  node [shape=ellipse, fontname=\"Courier\"];\n";
-    int counter = 0;
-    dotHelper(root, out, counter);
+    /* El índice de cada nodo en el arreglo sirve directamente de id */
+    for (std::size_t i = 0; i < tree.nodes.size(); ++i) {
+        const HuffmanNode& node = tree.nodes[i];
+
+        std::ostringstream label;
+        if (node.isLeaf())
+            label << node.character << " (" << node.frequency << ")";
+        else
+            label << "*" << " (" << node.frequency << ")";
+        out << "  n" << i << " [label=\"" << label.str() << "\"];\n";
+
+        if (!node.isLeaf()) {
+            out << "  n" << i << " -> n" << node.left  << " [label=\"0\"];\n";
+            out << "  n" << i << " -> n" << node.right << " [label=\"1\"];\n";
+        }
+    }
     out << "}\n";
     std::cout << "DOT file written: " << dotPath << '\n';
 }
@@ -1,11 +1,79 @@
 #include "frequency.h"
 
-std::unordered_map<char, int> computeFrequencies(const std::string& text) {
-    std::unordered_map<char, int> frequencyMap;
+#include <algorithm>
+#include <cstring>   // std::memcpy
+#include <functional>
+#include <thread>
+#include <vector>
 
-    for (char c : text) {
-        frequencyMap[c]++;
+/** @brief Bytes que un sub-histograma de 32 bits puede contar sin desbordar. */
+static constexpr std::size_t CHUNK_BYTES = std::size_t(1) << 30;
+
+/** @brief Tamaño mínimo de tramo para que merezca la pena lanzar un hilo. */
+static constexpr std::size_t MIN_BYTES_PER_THREAD = std::size_t(1) << 20;
+
+/** @brief Histograma de un tramo con 4 sub-histogramas intercalados. */
+static void countRange(const uint8_t* data, std::size_t size, Histogram& out)
+{
+    std::array<std::array<uint32_t, 256>, 4> sub;
+
+    while (size > 0) {
+        std::size_t chunk = std::min(size, CHUNK_BYTES);
+        for (auto& h : sub) h.fill(0);
+
+        std::size_t i = 0;
+        for (; i + 8 <= chunk; i += 8) {
+            uint64_t w;
+            std::memcpy(&w, data + i, sizeof(w));
+            ++sub[0][uint8_t(w)];
+            ++sub[1][uint8_t(w >> 8)];
+            ++sub[2][uint8_t(w >> 16)];
+            ++sub[3][uint8_t(w >> 24)];
+            ++sub[0][uint8_t(w >> 32)];
+            ++sub[1][uint8_t(w >> 40)];
+            ++sub[2][uint8_t(w >> 48)];
+            ++sub[3][uint8_t(w >> 56)];
+        }
+        for (; i < chunk; ++i) ++sub[0][data[i]];
+
+        for (unsigned s = 0; s < 256; ++s)
+            out[s] += uint64_t(sub[0][s]) + sub[1][s] + sub[2][s] + sub[3][s];
+
+        data += chunk;
+        size -= chunk;
     }
+}
+
+Histogram computeHistogram(const uint8_t* data, std::size_t size, unsigned threads)
+{
+    Histogram hist{};
+
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    threads = static_cast<unsigned>(
+        std::min<std::size_t>(threads, size / MIN_BYTES_PER_THREAD));
+
+    if (threads <= 1) {
+        countRange(data, size, hist);
+        return hist;
+    }
+
+    /* Un histograma privado por hilo; se suman al final */
+    std::vector<Histogram> partial(threads, Histogram{});
+    std::vector<std::thread> workers;
+    std::size_t slice = size / threads;
+    for (unsigned t = 0; t < threads; ++t) {
+        std::size_t begin = t * slice;
+        std::size_t len   = (t + 1 == threads) ? size - begin : slice;
+        workers.emplace_back(countRange, data + begin, len, std::ref(partial[t]));
+    }
+    for (auto& w : workers) w.join();
+
+    for (const Histogram& h : partial)
+        for (unsigned s = 0; s < 256; ++s) hist[s] += h[s];
+    return hist;
+}
 
-    return frequencyMap;
+Histogram computeFrequencies(const std::string& text) {
+    return computeHistogram(reinterpret_cast<const uint8_t*>(text.data()),
+                            text.size());
 }
@@ -1,8 +1,11 @@
 #include <iostream>
 #include <string>
-#include <unordered_map>
 #include <fstream>
 #include <algorithm>
+#include <cstdlib>
+#include <iomanip>
+#include <filesystem>
+#include <vector>
 
 #include "frequency.h"
 #include "HuffmanNode.h"
@@ -12,9 +15,16 @@
 #include "HuffmanEncoder.h"
 #include "HuffmanDecoder.h"
 #include "CompressedIO.h"
+#include "Dictionary.h"
+#include "Batch.h"
+#include "FileIO.h"
 
+using huffman::util::compressStream;
+using huffman::util::decompressStream;
 using huffman::util::writeCompressedFile;
 using huffman::util::readCompressedFile;
+using huffman::util::CompressOptions;
+using huffman::util::Format;
 
 /* ------------------------------------------------------------------------- */
 /*  HELP                                                                     */
@@ -23,12 +33,187 @@ static void printHelp()
 {
     std::cout <<
       "HuffmanCoding — command-line usage\n"
-      "  -c <input> <output.huf>   Compress file\n"
-      "  -d <input.huf> <output>   Decompress file\n"
+      "  -c <input> <output.huf>   Compress file ('-' = stdin/stdout)\n"
+      "  -d <input.huf> <output>   Decompress file ('-' = stdin/stdout)\n"
+      "  --tree                    (after -c) export Huffman tree as tree.dot/.svg\n"
+      "  --block-size <bytes>      (after -c) raw bytes per HUF2 frame (default 1 MiB)\n"
+      "  --huf1 | --huf0           (after -c) write a legacy single-block format\n"
+      "  --max-code-len <N>        (after -c) limit code lengths to N bits (default 12, max 15)\n"
+      "  --streams <1|4>           (after -c) interleaved Huffman streams per HUF2 block (default 4)\n"
+      "  --sub-block <bytes>       (after -c) bytes per table decision inside a frame (default 64 KiB, 0 = frame)\n"
+      "  -j <N>                    (after -c/-d) worker threads for HUF2 (0 = all cores)\n"
+      "  --dict <table.huft>       (after -c/-d) code blocks with a trained table\n"
+      "  --stats                   (after -c/-d) print sizes, code lengths and time per stage\n"
+      "  --seekable                (after -c) append a frame index for -x\n"
+      "  --checksum                (after -c) CRC-32C per frame and for the whole file\n"
+      "  -x <input.huf> <offset> <length> [output]\n"
+      "                            Decode only that byte range of a seekable file\n"
+      "                            (default output: stdout; --dict applies here too)\n"
+      "  -c|-d --batch <list|dir> --out-dir <dir>\n"
+      "                            Process every file of a list (one path per line) or\n"
+      "                            directory tree on -j workers (default all cores)\n"
+      "  -train <path>... -o <table.huft>\n"
+      "                            Train a table from sample files or directories\n"
+      "                            (--max-code-len applies here too)\n"
       "  -h                        Show this help\n"
       "If no flag is given, a built-in demo with the text \"abracadabra\" runs.\n";
 }
 
+/* ------------------------------------------------------------------------- */
+/*  STREAM HELPERS                                                           */
+/* ------------------------------------------------------------------------- */
+
+/**
+ * @brief Abre `in`/`out` (o stdin/stdout si son "-") y ejecuta `fn` sobre ellos.
+ */
+template <typename Fn>
+static bool withStreams(const std::string& in, const std::string& out, Fn fn)
+{
+    std::ifstream inFile;
+    std::ofstream outFile;
+    std::istream* is = &std::cin;
+    std::ostream* os = &std::cout;
+
+    if (in != "-") {
+        inFile.open(in, std::ios::binary);
+        if (!inFile) return false;
+        is = &inFile;
+    }
+    if (out != "-") {
+        outFile.open(out, std::ios::binary);
+        if (!outFile) return false;
+        os = &outFile;
+    }
+    return fn(*is, *os);
+}
+
+/**
+ * @brief Suma al histograma los bytes de `path` (fichero o directorio, recursivo).
+ *
+ * @return false si alguna ruta no existe o no se puede leer.
+ */
+static bool addSamples(const std::string& path, Histogram& hist,
+                       std::size_t& files, uint64_t& bytes)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+
+    std::vector<std::string> paths;
+    if (fs::is_directory(path, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(path, ec))
+            if (entry.is_regular_file(ec)) paths.push_back(entry.path().string());
+        std::sort(paths.begin(), paths.end());   // mismo orden en cada ejecución
+    } else if (fs::is_regular_file(path, ec)) {
+        paths.push_back(path);
+    }
+    if (ec || paths.empty()) return false;
+
+    for (const std::string& p : paths) {
+        huffman::util::MappedFile mapped;
+        Histogram h = mapped.open(p) ? computeHistogram(mapped.data(), mapped.size())
+                                     : computeFrequencies(readFileToString(p));
+        for (unsigned s = 0; s < h.size(); ++s) {
+            hist[s] += h[s];
+            bytes   += h[s];
+        }
+        ++files;
+    }
+    return true;
+}
+
+/**
+ * @brief Ruta relativa segura: sin raíz, sin "." ni "..", para colgarla de --out-dir.
+ */
+static std::filesystem::path relativeOutput(const std::filesystem::path& path)
+{
+    std::filesystem::path rel;
+    for (const auto& part : path.lexically_normal().relative_path())
+        if (part != "." && part != "..") rel /= part;
+    return rel;
+}
+
+/**
+ * @brief Ficheros de un lote: `source` es un directorio (recursivo) o una
+ *        lista con una ruta por línea.
+ *
+ * Cada salida reproduce bajo `outDir` la ruta relativa de su entrada; al
+ * comprimir se añade ".huf" y al descomprimir se quita (o se añade ".out").
+ *
+ * @return false si `source` no existe o no se puede leer.
+ */
+static bool collectBatch(const std::string& source, const std::string& outDir,
+                         bool compress, std::vector<huffman::util::BatchFile>& files)
+{
+    namespace fs = std::filesystem;
+    std::error_code ec;
+
+    std::vector<std::pair<fs::path, fs::path>> inputs;   // ruta, ruta relativa
+    if (fs::is_directory(source, ec)) {
+        for (const auto& entry : fs::recursive_directory_iterator(source, ec))
+            if (entry.is_regular_file(ec))
+                inputs.emplace_back(entry.path(), entry.path().lexically_relative(source));
+        std::sort(inputs.begin(), inputs.end());   // mismo orden en cada ejecución
+    } else {
+        std::ifstream list(source);
+        if (!list) return false;
+        std::string line;
+        while (std::getline(list, line)) {
+            if (!line.empty() && line.back() == '\r') line.pop_back();
+            if (!line.empty()) inputs.emplace_back(line, relativeOutput(line));
+        }
+    }
+    if (ec) return false;
+
+    for (const auto& [path, rel] : inputs) {
+        std::string out = (fs::path(outDir) / rel).string();
+        if (compress)
+            out += ".huf";
+        else if (rel.extension() == ".huf")
+            out.resize(out.size() - 4);
+        else
+            out += ".out";
+
+        huffman::util::BatchFile file;
+        file.input  = path.string();
+        file.output = std::move(out);
+        files.push_back(std::move(file));
+    }
+    return true;
+}
+
+/**
+ * @brief Progreso del lote: cada fallo a stderr según llega y, con
+ *        `verbose` (--stats), una línea por fichero terminado.
+ */
+static huffman::util::BatchCallback batchProgress(bool verbose)
+{
+    return [verbose](const huffman::util::BatchFile& file) {
+        if (!file.ok)
+            std::cerr << "✗ " << file.input << ": " << file.error << '\n';
+        else if (verbose)
+            std::cout << "  " << file.input << " → " << file.output << ": "
+                      << file.stats.inputBytes << " → " << file.stats.outputBytes
+                      << " bytes, " << std::fixed << std::setprecision(2)
+                      << double(file.stats.totalNs) / 1e6 << " ms\n";
+    };
+}
+
+/** @brief Resumen final: ficheros, bytes y rendimiento agregado. */
+static int printBatchReport(const char* verb, const huffman::util::BatchReport& report)
+{
+    double seconds = double(report.totalNs) / 1e9;
+    std::cout << (report.failed ? "✗ " : "✔ ") << verb << ' '
+              << report.files - report.failed << " of " << report.files << " files: "
+              << report.inputBytes << " → " << report.outputBytes << " bytes in "
+              << std::fixed << std::setprecision(3) << seconds << " s";
+    if (seconds > 0)
+        std::cout << std::setprecision(1) << " (in " << double(report.inputBytes) / 1e6 / seconds
+                  << " MB/s, out " << double(report.outputBytes) / 1e6 / seconds << " MB/s, "
+                  << double(report.files) / seconds << " files/s)";
+    std::cout << '\n';
+    return report.failed ? 1 : 0;
+}
+
 /* ------------------------------------------------------------------------- */
 /*  DEMO PIPELINE (your entire original flow)                                */
 /* ------------------------------------------------------------------------- */
@@ -38,31 +223,41 @@ static int runDemo()
     std::cout << "Texto original: " << texto << "\n";
 
     /* 1. Frecuencias + histograma */
-    auto freqMap = computeFrequencies(texto);
-    printFrequencyHistogram(freqMap);
+    Histogram hist = computeFrequencies(texto);
+    printFrequencyHistogram(hist);
 
     /* 2. Árbol */
-    HuffmanNode* root = buildHuffmanTree(freqMap);
+    HuffmanTree tree;
+    buildHuffmanTree(hist, tree);
     std::cout << "\nÁrbol de Huffman (pretty):\n";
-    printHuffmanTreePretty(root);
+    printHuffmanTreePretty(tree);
 
     /* 3. Generar códigos */
-    auto codes = generateHuffmanCodes(root);
+    auto codes = generateHuffmanCodes(tree);
     std::cout << "\nCódigos Huffman:\n";
-    for (auto const& [ch, code] : codes)
-        std::cout << "'" << ch << "' => " << code << '\n';
+    for (unsigned s = 0; s < codes.size(); ++s)
+        if (codes[s].len)
+            std::cout << "'" << static_cast<char>(s) << "' => "
+                      << codeToString(codes[s]) << '\n';
 
     /* 4. Codificar + stats */
     std::string encoded = encodeText(texto, codes);
-    reportCompressionStats(texto, encoded);
+    huffman::util::Stats stats;
+    stats.inputBytes   = texto.size();
+    stats.outputBytes  = (encoded.size() + 7) / 8;
+    stats.codedSymbols = texto.size();
+    stats.codedBits    = stats.payloadBits = stats.optimalBits = encoded.size();
+    for (unsigned s = 0; s < codes.size(); ++s)
+        stats.maxCodeLen = std::max<unsigned>(stats.maxCodeLen, codes[s].len);
+    std::cout << '\n';
+    printStats(stats);
 
     /* 5. Decodificar verificación */
-    std::string decoded = decodeText(encoded, root);
+    std::string decoded = decodeText(encoded, tree);
     std::cout << "\nTexto decodificado: " << decoded << "\n";
     std::cout << (decoded == texto ?
         "✔ Round-trip OK\n" : "✗ Round-trip failed\n");
 
-    deleteTree(root);
     return 0;
 }
 
@@ -71,29 +266,147 @@ static int runDemo()
 /* ------------------------------------------------------------------------- */
 int main(int argc, char* argv[])
 {
+    std::ios::sync_with_stdio(false);   // stdin/stdout se usan como flujos binarios
+
     /* 1. Ayuda */
     if (argc == 2 && std::string(argv[1]) == "-h") {
         printHelp();
         return 0;
     }
 
-    /* 2. Compress: -c in out.huf */
-    /* 2. Compress */
+    /* 2. Train: -train samples... -o table.huft */
+    if (argc >= 4 && std::string(argv[1]) == "-train") {
+        std::vector<std::string> samples;
+        std::string out;
+        unsigned maxCodeLen = huffman::DEFAULT_MAX_CODE_LEN;
+        for (int i = 2; i < argc; ++i) {
+            std::string opt = argv[i];
+            if (opt == "-o" && i + 1 < argc) out = argv[++i];
+            else if (opt == "--max-code-len" && i + 1 < argc)
+                maxCodeLen = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else samples.push_back(opt);
+        }
+        if (out.empty() || samples.empty()) {
+            std::cerr << "-train needs sample paths and -o <table.huft>\n";
+            return 1;
+        }
+
+        Histogram   hist{};
+        std::size_t files = 0;
+        uint64_t    bytes = 0;
+        for (const std::string& path : samples)
+            if (!addSamples(path, hist, files, bytes)) {
+                std::cerr << "✗ Cannot read samples from '" << path << "'\n";
+                return 1;
+            }
+
+        huffman::Dictionary dict;
+        dict.train(hist, maxCodeLen);
+        if (!dict.save(out)) {
+            std::cerr << "✗ Cannot write '" << out << "'\n";
+            return 1;
+        }
+        std::cout << "✔ Trained '" << out << "' from " << files << " files ("
+                  << bytes << " bytes), id " << std::hex << dict.id() << std::dec << '\n';
+        return 0;
+    }
+
+    /* 3. Compress: -c in out.huf */
     if (argc >= 4 && std::string(argv[1]) == "-c") {
         std::string in  = argv[2];
         std::string out = argv[3];
-        bool genTree = (argc == 5 && std::string(argv[4]) == "--tree");
+        const bool batch = in == "--batch";   // -c --batch <list|dir> --out-dir <dir>
+        if (batch) { in = argv[3]; out.clear(); }
+        bool genTree = false, showStats = false;
+        huffman::Dictionary dict;
+        huffman::util::Stats stats;
+        CompressOptions options;
+        options.stats   = &stats;
+        options.threads = batch ? 0 : 1;
+        for (int i = 4; i < argc; ++i) {
+            std::string opt = argv[i];
+            if (opt == "--tree")       genTree = true;
+            else if (opt == "--stats") showStats = true;
+            else if (opt == "--out-dir" && batch && i + 1 < argc) out = argv[++i];
+            else if (opt == "--seekable") options.seekable = true;
+            else if (opt == "--checksum") options.checksum = true;
+            else if (opt == "--huf0") options.format = Format::HUF0;
+            else if (opt == "--huf1") options.format = Format::HUF1;
+            else if (opt == "--max-code-len" && i + 1 < argc)
+                options.maxCodeLen = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (opt == "--streams" && i + 1 < argc)
+                options.streams = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (opt == "--sub-block" && i + 1 < argc)
+                options.subBlockSize = std::strtoull(argv[++i], nullptr, 10);
+            else if (opt == "--block-size" && i + 1 < argc)
+                options.blockSize = std::strtoull(argv[++i], nullptr, 10);
+            else if (opt == "-j" && i + 1 < argc)
+                options.threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (opt == "--dict" && i + 1 < argc) {
+                if (!dict.load(argv[++i])) {
+                    std::cerr << "✗ Cannot load table '" << argv[i] << "'\n";
+                    return 1;
+                }
+                options.dictionary = &dict;
+            }
+            else { std::cerr << "Unknown option: " << opt << '\n'; return 1; }
+        }
+        if (options.maxCodeLen == 0 || options.maxCodeLen > huffman::MAX_STORED_CODE_LEN) {
+            std::cerr << "--max-code-len must be between 1 and "
+                      << huffman::MAX_STORED_CODE_LEN << '\n';
+            return 1;
+        }
+        if (options.streams != 1 && options.streams != 4) {
+            std::cerr << "--streams must be 1 or 4\n";
+            return 1;
+        }
+        if (genTree && (in == "-" || batch)) {
+            std::cerr << "--tree needs a single file input\n";
+            return 1;
+        }
+        if (batch) {
+            std::vector<huffman::util::BatchFile> files;
+            if (out.empty()) {
+                std::cerr << "--batch needs --out-dir <dir>\n";
+                return 1;
+            }
+            if (!collectBatch(in, out, true, files)) {
+                std::cerr << "✗ Cannot read file list '" << in << "'\n";
+                return 1;
+            }
+            auto report = huffman::util::compressBatch(files, options, options.threads,
+                                                       batchProgress(showStats));
+            return printBatchReport("Compressed", report);
+        }
 
-        if (writeCompressedFile(in, out)) {
-            std::cout << "✔ Compressed '" << in << "' → '" << out << "'\n";
+        /* stdout may carry the compressed data: report on stderr then */
+        std::ostream& status = (out == "-") ? std::cerr : std::cout;
+        /* two real files: mmap + large writes; otherwise iostreams */
+        bool ok = (in != "-" && out != "-")
+            ? writeCompressedFile(in, out, options)
+            : withStreams(in, out, [&](std::istream& is, std::ostream& os) {
+                  return compressStream(is, os, options);
+              });
+        if (ok) {
+            status << "✔ Compressed '" << in << "' → '" << out << "'\n";
+            if (stats.optimalBits > 0) {
+                double lost = 100.0 * (double(stats.payloadBits) - double(stats.optimalBits))
+                            / double(stats.optimalBits);
+                status << "  payload " << stats.payloadBits << " bits, optimal Huffman "
+                       << stats.optimalBits << " bits (+" << std::fixed
+                       << std::setprecision(3) << lost << " % from the length limit)\n";
+            }
+            if (showStats) printStats(stats, status);
 
             if (genTree) {
                 /* rebuild tree just for visualisation */
-                std::string data = readFileToString(in);
-                auto freq   = computeFrequencies(data);
-                HuffmanNode* root = buildHuffmanTree(freq);
-                exportTreeToDot(root, "tree.dot");
-                deleteTree(root);
+                huffman::util::MappedFile mapped;
+                auto freq = mapped.open(in)
+                    ? computeHistogram(mapped.data(), mapped.size())
+                    : computeFrequencies(readFileToString(in));
+                HuffmanTree tree;
+                buildHuffmanTree(freq, tree);
+                exportTreeToDot(tree, "tree.dot");
 
                 /* call Graphviz if installed */
                 int rc = std::system("dot -Tsvg tree.dot -o tree.svg");
@@ -108,19 +421,106 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    /* 3. Decompress: -d in.huf out */
-    if (argc == 4 && std::string(argv[1]) == "-d") {
+    /* 4. Decompress: -d in.huf out */
+    if (argc >= 4 && std::string(argv[1]) == "-d") {
         std::string in  = argv[2];
         std::string out = argv[3];
-        if (readCompressedFile(in, out)) {
-            std::cout << "✔ Decompressed '" << in << "' → '" << out << "'\n";
+        const bool batch = in == "--batch";
+        if (batch) { in = argv[3]; out.clear(); }
+        unsigned threads = batch ? 0 : 1;
+        bool showStats = false;
+        huffman::Dictionary dict;
+        const huffman::Dictionary* dictionary = nullptr;
+        huffman::util::Stats stats;
+        for (int i = 4; i < argc; ++i) {
+            std::string opt = argv[i];
+            if (opt == "--stats") showStats = true;
+            else if (opt == "--out-dir" && batch && i + 1 < argc) out = argv[++i];
+            else if (opt == "-j" && i + 1 < argc)
+                threads = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            else if (opt == "--dict" && i + 1 < argc) {
+                if (!dict.load(argv[++i])) {
+                    std::cerr << "✗ Cannot load table '" << argv[i] << "'\n";
+                    return 1;
+                }
+                dictionary = &dict;
+            }
+            else { std::cerr << "Unknown option: " << opt << '\n'; return 1; }
+        }
+
+        if (batch) {
+            std::vector<huffman::util::BatchFile> files;
+            if (out.empty()) {
+                std::cerr << "--batch needs --out-dir <dir>\n";
+                return 1;
+            }
+            if (!collectBatch(in, out, false, files)) {
+                std::cerr << "✗ Cannot read file list '" << in << "'\n";
+                return 1;
+            }
+            auto report = huffman::util::decompressBatch(files, threads, dictionary,
+                                                         batchProgress(showStats));
+            return printBatchReport("Decompressed", report);
+        }
+
+        std::ostream& status = (out == "-") ? std::cerr : std::cout;
+        bool ok = (in != "-" && out != "-")
+            ? readCompressedFile(in, out, threads, dictionary, &stats)
+            : withStreams(in, out, [&](std::istream& is, std::ostream& os) {
+                  return decompressStream(is, os, threads, dictionary, &stats);
+              });
+        if (ok) {
+            status << "✔ Decompressed '" << in << "' → '" << out << "'\n";
+            if (showStats) printStats(stats, status);
             return 0;
         }
         std::cerr << "✗ Decompression failed (corrupt file?)\n";
         return 1;
     }
 
-    /* 4. Sin flags → demo */
+    /* 5. Extract: -x in.huf offset length [out] */
+    if (argc >= 5 && std::string(argv[1]) == "-x") {
+        std::string in  = argv[2];
+        uint64_t offset = std::strtoull(argv[3], nullptr, 10);
+        uint64_t length = std::strtoull(argv[4], nullptr, 10);
+        std::string out = "-";
+        huffman::Dictionary dict;
+        const huffman::Dictionary* dictionary = nullptr;
+        for (int i = 5; i < argc; ++i) {
+            std::string opt = argv[i];
+            if (opt == "--dict" && i + 1 < argc) {
+                if (!dict.load(argv[++i])) {
+                    std::cerr << "✗ Cannot load table '" << argv[i] << "'\n";
+                    return 1;
+                }
+                dictionary = &dict;
+            }
+            else if (i == 5) out = opt;
+            else { std::cerr << "Unknown option: " << opt << '\n'; return 1; }
+        }
+
+        std::vector<uint8_t> bytes;
+        if (!huffman::util::extractRange(in, offset, length, bytes, dictionary)) {
+            std::cerr << "✗ Cannot extract from '" << in
+                      << "' (not seekable, corrupt, or offset past the end?)\n";
+            return 1;
+        }
+        bool ok = withStreams("-", out, [&](std::istream&, std::ostream& os) {
+            os.write(reinterpret_cast<const char*>(bytes.data()),
+                     static_cast<std::streamsize>(bytes.size()));
+            return static_cast<bool>(os.flush());
+        });
+        if (!ok) {
+            std::cerr << "✗ Cannot write '" << out << "'\n";
+            return 1;
+        }
+        if (out != "-")
+            std::cout << "✔ Extracted " << bytes.size() << " bytes at " << offset
+                      << " from '" << in << "' → '" << out << "'\n";
+        return 0;
+    }
+
+    /* 6. Sin flags → demo */
     printHelp();
     std::cout << "\n--- Running demo ---\n";
     return runDemo();